@@ -0,0 +1,276 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-09
+ */
+
+#ifndef HFT_COMMON_BINARYLOGGER_HPP
+#define HFT_COMMON_BINARYLOGGER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <spdlog/sinks/sink.h>
+#include <spdlog/spdlog.h>
+
+#include "constants.hpp"
+#include "market_types.hpp"
+#include "utils/string_utils.hpp"
+
+/**
+ * @brief Levels below this one are compiled out of the HFT_LOG_* macros entirely
+ */
+#ifndef HFT_LOG_ACTIVE_LEVEL
+#define HFT_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+namespace hft {
+
+/**
+ * @brief Static description of a log call site, its address serves as the format id
+ */
+struct LogSite {
+  spdlog::level::level_enum level;
+  const char *format;
+};
+
+/**
+ * @brief Deferred formatting logger for hot paths
+ * Producer copies site pointer, timestamp and raw POD arguments into a fixed size slot of
+ * its own SPSC ring, background thread decodes, formats and writes to the file sink.
+ * Records are dropped and counted when the ring is full, producer never blocks
+ */
+class BinaryLogger {
+  static constexpr size_t SLOT_SIZE = 2 * CACHE_LINE_SIZE;
+  static constexpr size_t RING_SIZE = 1 << 14;
+  static constexpr size_t RING_MASK = RING_SIZE - 1;
+  static constexpr auto IDLE_SLEEP = std::chrono::microseconds(200);
+
+  using DecodeFn = std::string (*)(const char *format, const std::byte *payload);
+
+  struct Header {
+    const LogSite *site;
+    DecodeFn decode;
+    int64_t timestamp;
+  };
+  static constexpr size_t PAYLOAD_SIZE = SLOT_SIZE - sizeof(Header);
+
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    Header header;
+    std::byte payload[PAYLOAD_SIZE];
+  };
+  static_assert(sizeof(Slot) == SLOT_SIZE);
+
+  struct Ring {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dropped{0};
+    Slot slots[RING_SIZE];
+  };
+
+public:
+  static inline bool enabled(spdlog::level::level_enum level) {
+    return level >= sLevel.load(std::memory_order_relaxed);
+  }
+
+  static void setLevel(spdlog::level::level_enum level) {
+    sLevel.store(level, std::memory_order_relaxed);
+  }
+
+  static void start(spdlog::sink_ptr sink) {
+    if (sRunning.exchange(true)) {
+      return;
+    }
+    sSink = std::move(sink);
+    sWorker = std::thread([]() { run(); });
+  }
+
+  static void stop() {
+    if (!sRunning.exchange(false)) {
+      return;
+    }
+    sWorker.join();
+    sSink->flush();
+  }
+
+  template <typename... Args>
+  static inline void log(const LogSite &site, const Args &...args) {
+    static_assert((std::is_trivially_copyable_v<Args> && ...),
+                  "Binary logger takes trivially copyable arguments only");
+    static_assert((sizeof(Args) + ... + 0) <= PAYLOAD_SIZE, "Log arguments exceed slot payload");
+    if (!sRunning.load(std::memory_order_relaxed)) {
+      spdlog::log(site.level, decode<Args...>(site.format, args...));
+      return;
+    }
+    Ring &ring = threadRing();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) == RING_SIZE) {
+      ring.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    Slot &slot = ring.slots[head & RING_MASK];
+    slot.header.site = &site;
+    slot.header.decode = &decodePayload<Args...>;
+    slot.header.timestamp = spdlog::log_clock::now().time_since_epoch().count();
+    size_t offset = 0;
+    ((std::memcpy(slot.payload + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+
+private:
+  template <typename Type>
+  static decltype(auto) printable(const Type &value) {
+    if constexpr (std::is_same_v<Type, Order> || std::is_same_v<Type, OrderStatus> ||
+                  std::is_same_v<Type, TickerPrice> || std::is_same_v<Type, OrderAction> ||
+                  std::is_same_v<Type, OrderState> || std::is_same_v<Type, OrderType> ||
+                  std::is_same_v<Type, TimeInForce>) {
+      return utils::toString(value);
+    } else if constexpr (std::is_same_v<Type, Ticker>) {
+      return utils::toStrView(value);
+    } else {
+      return value;
+    }
+  }
+
+  template <typename... Args>
+  static std::string decode(const char *format, const Args &...args) {
+    return std::apply(
+        [format](const auto &...values) {
+          return std::vformat(format, std::make_format_args(values...));
+        },
+        std::make_tuple(printable(args)...));
+  }
+
+  template <typename... Args>
+  static std::string decodePayload(const char *format, const std::byte *payload) {
+    std::tuple<Args...> args;
+    size_t offset = 0;
+    std::apply(
+        [&](auto &...values) {
+          ((std::memcpy(&values, payload + offset, sizeof(values)), offset += sizeof(values)),
+           ...);
+        },
+        args);
+    return std::apply([format](const auto &...values) { return decode(format, values...); },
+                      args);
+  }
+
+  static Ring &threadRing() {
+    thread_local Ring *ring = [] {
+      std::lock_guard lock{sRingsMtx};
+      sRings.emplace_back(std::make_unique<Ring>());
+      return sRings.back().get();
+    }();
+    return *ring;
+  }
+
+  static void run() {
+    std::vector<Ring *> rings;
+    std::vector<uint64_t> reported;
+    while (true) {
+      const bool running = sRunning.load(std::memory_order_acquire);
+      {
+        std::lock_guard lock{sRingsMtx};
+        rings.clear();
+        for (auto &ring : sRings) {
+          rings.push_back(ring.get());
+        }
+      }
+      reported.resize(rings.size(), 0);
+      size_t drained = 0;
+      for (size_t i = 0; i < rings.size(); ++i) {
+        drained += drain(*rings[i]);
+        const uint64_t dropped = rings[i]->dropped.load(std::memory_order_relaxed);
+        if (dropped != reported[i]) {
+          spdlog::warn("Binary logger dropped {} records", dropped - reported[i]);
+          reported[i] = dropped;
+        }
+      }
+      if (!running) {
+        break;
+      }
+      if (drained == 0) {
+        std::this_thread::sleep_for(IDLE_SLEEP);
+      }
+    }
+  }
+
+  static size_t drain(Ring &ring) {
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    const size_t count = head - tail;
+    for (; tail != head; ++tail) {
+      const Slot &slot = ring.slots[tail & RING_MASK];
+      const auto &header = slot.header;
+      try {
+        std::string text = header.decode(header.site->format, slot.payload);
+        spdlog::details::log_msg msg{
+            spdlog::log_clock::time_point{spdlog::log_clock::duration{header.timestamp}},
+            spdlog::source_loc{}, "", header.site->level, text};
+        sSink->log(msg);
+      } catch (const std::exception &e) {
+        spdlog::error("Binary logger failed to format '{}': {}", header.site->format, e.what());
+      }
+      ring.tail.store(tail + 1, std::memory_order_release);
+    }
+    return count;
+  }
+
+private:
+  static inline std::atomic<spdlog::level::level_enum> sLevel{spdlog::level::info};
+  static inline std::atomic_bool sRunning{false};
+  static inline spdlog::sink_ptr sSink;
+  static inline std::thread sWorker;
+  static inline std::mutex sRingsMtx;
+  static inline std::vector<std::unique_ptr<Ring>> sRings;
+};
+
+} // namespace hft
+
+#define HFT_LOG_IMPL(lvl, fmt, ...)                                                              \
+  do {                                                                                           \
+    if (::hft::BinaryLogger::enabled(lvl)) [[unlikely]] {                                        \
+      static constexpr ::hft::LogSite hftLogSite{lvl, fmt};                                      \
+      ::hft::BinaryLogger::log(hftLogSite __VA_OPT__(, ) __VA_ARGS__);                           \
+    }                                                                                            \
+  } while (0)
+
+#if HFT_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define HFT_LOG_TRACE(fmt, ...) HFT_LOG_IMPL(spdlog::level::trace, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define HFT_LOG_TRACE(fmt, ...) (void)0
+#endif
+
+#if HFT_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define HFT_LOG_DEBUG(fmt, ...) HFT_LOG_IMPL(spdlog::level::debug, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define HFT_LOG_DEBUG(fmt, ...) (void)0
+#endif
+
+#if HFT_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define HFT_LOG_INFO(fmt, ...) HFT_LOG_IMPL(spdlog::level::info, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define HFT_LOG_INFO(fmt, ...) (void)0
+#endif
+
+#if HFT_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define HFT_LOG_WARN(fmt, ...) HFT_LOG_IMPL(spdlog::level::warn, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define HFT_LOG_WARN(fmt, ...) (void)0
+#endif
+
+#if HFT_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define HFT_LOG_ERROR(fmt, ...) HFT_LOG_IMPL(spdlog::level::err, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define HFT_LOG_ERROR(fmt, ...) (void)0
+#endif
+
+#endif // HFT_COMMON_BINARYLOGGER_HPP
@@ -24,17 +24,95 @@ struct Config {
   Port portTcpIn;
   Port portTcpOut;
   Port portUdp;
+  Port portUdpConflated;
   std::vector<uint8_t> coreIds;
+  String simdLevel;
+  String tickerSource;
+  String tickerFile;
   size_t tradeRateUs;
   size_t priceFeedRateUs;
+  size_t priceConflatedRateUs;
   uint16_t monitorRateS;
+  uint16_t sessionCount;
+  uint16_t maxSessions;
+  size_t rebalanceRateS;
+  double rebalanceSkew;
+  size_t orderSlabSize;
+  size_t workerQueueSize;
+  size_t matchBatchSize;
+  uint16_t hotTickers;
+  uint8_t hotSharePct;
+  String tradeMode;
+  uint64_t rngSeed;
+  String strategy;
+  uint32_t quoteSize;
+  uint32_t quoteSpread;
+  uint32_t maxPosition;
+  uint32_t momentumBp;
+  String replayFile;
+  uint32_t maxOrderQuantity;
+  uint64_t maxOrderNotional;
+  uint32_t maxOpenOrders;
+  uint32_t priceCollarPct;
+  uint32_t marketProtectionPct;
+  String selfTrade;
+  uint32_t orderRateLimit;
+  uint32_t orderBurst;
+  String journalPath;
+  size_t journalSegmentMb;
+  size_t journalSyncUs;
+  String snapshotPath;
+  size_t snapshotRateS;
+  String capturePath;
+  size_t captureQueueSize;
+  String tradeSink;
+  String tradeFile;
+  size_t tradeQueueSize;
+  size_t tradeBatchSize;
+  size_t poolArenaMb;
+  bool poolHugePages;
 
   static Config cfg;
   static void logConfig() {
-    Logger::monitorLogger->info("Url:{} TcpIn:{} TcpOut:{} Udp:{}", cfg.url, cfg.portTcpIn,
-                                cfg.portTcpOut, cfg.portUdp);
-    Logger::monitorLogger->info("IoCoreIDs:{} TradeRate:{}us PriceFeedRate:{}us",
-                                utils::toString(cfg.coreIds), cfg.tradeRateUs, cfg.priceFeedRateUs);
+    Logger::monitorLogger->info("Url:{} TcpIn:{} TcpOut:{} Udp:{} UdpConflated:{}", cfg.url,
+                                cfg.portTcpIn, cfg.portTcpOut, cfg.portUdp,
+                                cfg.portUdpConflated);
+    Logger::monitorLogger->info("IoCoreIDs:{} Simd:{} TradeRate:{}us PriceFeedRate:{}us "
+                                "ConflatedRate:{}us",
+                                utils::toString(cfg.coreIds), cfg.simdLevel, cfg.tradeRateUs,
+                                cfg.priceFeedRateUs, cfg.priceConflatedRateUs);
+    Logger::monitorLogger->info("Tickers:{} {}", cfg.tickerSource,
+                                cfg.tickerSource == "file" ? cfg.tickerFile : "");
+    Logger::monitorLogger->info("Sessions:{} MaxSessions:{} OrderSlab:{} WorkerQueue:{} "
+                                "MatchBatch:{}",
+                                cfg.sessionCount, cfg.maxSessions, cfg.orderSlabSize,
+                                cfg.workerQueueSize, cfg.matchBatchSize);
+    Logger::monitorLogger->info("RebalanceRate:{}s RebalanceSkew:{} HotTickers:{} HotShare:{}% "
+                                "TradeMode:{} Seed:{}",
+                                cfg.rebalanceRateS, cfg.rebalanceSkew, cfg.hotTickers,
+                                cfg.hotSharePct, cfg.tradeMode, cfg.rngSeed);
+    Logger::monitorLogger->info("Strategy:{} QuoteSize:{} QuoteSpread:{} MaxPosition:{} "
+                                "MomentumBp:{} Replay:{}",
+                                cfg.strategy, cfg.quoteSize, cfg.quoteSpread, cfg.maxPosition,
+                                cfg.momentumBp, cfg.replayFile);
+    Logger::monitorLogger->info("Risk MaxQty:{} MaxNotional:{} MaxOpen:{} Collar:{}% "
+                                "MarketProtection:{}% Rate:{}/s Burst:{} SelfTrade:{}",
+                                cfg.maxOrderQuantity, cfg.maxOrderNotional, cfg.maxOpenOrders,
+                                cfg.priceCollarPct, cfg.marketProtectionPct, cfg.orderRateLimit,
+                                cfg.orderBurst, cfg.selfTrade);
+    Logger::monitorLogger->info("Journal:{} Segment:{}MB Sync:{}us",
+                                cfg.journalPath.empty() ? "off" : cfg.journalPath,
+                                cfg.journalSegmentMb, cfg.journalSyncUs);
+    Logger::monitorLogger->info("Snapshot:{} SnapshotRate:{}s",
+                                cfg.snapshotPath.empty() ? "off" : cfg.snapshotPath,
+                                cfg.snapshotRateS);
+    Logger::monitorLogger->info("Capture:{} Queue:{}",
+                                cfg.capturePath.empty() ? "off" : cfg.capturePath,
+                                cfg.captureQueueSize);
+    Logger::monitorLogger->info("TradeSink:{} Queue:{} Batch:{}", cfg.tradeSink,
+                                cfg.tradeQueueSize, cfg.tradeBatchSize);
+    Logger::monitorLogger->info("BufferPool Arena:{}MB HugePages:{}", cfg.poolArenaMb,
+                                cfg.poolHugePages);
   }
 };
 
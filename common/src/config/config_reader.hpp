@@ -33,12 +33,75 @@ struct ConfigReader {
     Config::cfg.portTcpIn = pt.get<int>("network.port_tcp_in");
     Config::cfg.portTcpOut = pt.get<int>("network.port_tcp_out");
     Config::cfg.portUdp = pt.get<int>("network.port_udp");
+    Config::cfg.portUdpConflated = pt.get<int>("network.port_udp_conflated", 0);
 
     // Cpu
     Config::cfg.coreIds = parseCores(pt.get<std::string>("cpu.core_ids"));
+    Config::cfg.simdLevel = pt.get<std::string>("cpu.simd", "auto");
     Config::cfg.tradeRateUs = pt.get<int>("rates.trade_rate");
     Config::cfg.priceFeedRateUs = pt.get<int>("rates.price_feed_rate");
+    Config::cfg.priceConflatedRateUs = pt.get<int>("rates.price_feed_conflated_rate", 100000);
     Config::cfg.monitorRateS = pt.get<int>("rates.monitor_rate");
+
+    // Ticker universe, file is written by hft_ticker_export
+    Config::cfg.tickerSource = pt.get<std::string>("market_data.source", "postgres");
+    Config::cfg.tickerFile = pt.get<std::string>("market_data.file", "tickers.bin");
+
+    // Server
+    Config::cfg.maxSessions = pt.get<int>("server.max_sessions", 64);
+    Config::cfg.rebalanceRateS = pt.get<int>("server.rebalance_rate", 0);
+    Config::cfg.rebalanceSkew = pt.get<double>("server.rebalance_skew", 1.25);
+    Config::cfg.orderSlabSize = pt.get<size_t>("server.order_slab", 1 << 20);
+    Config::cfg.workerQueueSize = pt.get<size_t>("server.worker_queue", 65536);
+    Config::cfg.matchBatchSize = pt.get<size_t>("server.match_batch", 64);
+
+    // Risk, zero disables a limit
+    Config::cfg.maxOrderQuantity = pt.get<uint32_t>("risk.max_quantity", 0);
+    Config::cfg.maxOrderNotional = pt.get<uint64_t>("risk.max_notional", 0);
+    Config::cfg.maxOpenOrders = pt.get<uint32_t>("risk.max_open_orders", 0);
+    Config::cfg.priceCollarPct = pt.get<uint32_t>("risk.price_collar", 0);
+    Config::cfg.marketProtectionPct = pt.get<uint32_t>("risk.market_protection", 0);
+    Config::cfg.orderRateLimit = pt.get<uint32_t>("risk.rate_limit", 0);
+    Config::cfg.orderBurst = pt.get<uint32_t>("risk.burst", 0);
+    Config::cfg.selfTrade = pt.get<std::string>("risk.self_trade", "allow");
+
+    // Journal, empty path disables it
+    Config::cfg.journalPath = pt.get<std::string>("journal.path", "");
+    Config::cfg.journalSegmentMb = pt.get<int>("journal.segment_mb", 64);
+    Config::cfg.journalSyncUs = pt.get<int>("journal.sync_interval", 1000);
+
+    // Snapshot, empty path or zero rate disables it
+    Config::cfg.snapshotPath = pt.get<std::string>("snapshot.path", "");
+    Config::cfg.snapshotRateS = pt.get<int>("snapshot.rate", 0);
+
+    // Order flow capture for hft_order_replay, empty path disables it
+    Config::cfg.capturePath = pt.get<std::string>("capture.path", "");
+    Config::cfg.captureQueueSize = pt.get<size_t>("capture.queue_size", 65536);
+
+    // Trade persistence, sink is off, postgres or file
+    Config::cfg.tradeSink = pt.get<std::string>("persistence.sink", "off");
+    Config::cfg.tradeFile = pt.get<std::string>("persistence.file", "trades.csv");
+    Config::cfg.tradeQueueSize = pt.get<size_t>("persistence.queue_size", 65536);
+    Config::cfg.tradeBatchSize = pt.get<size_t>("persistence.batch_size", 1024);
+
+    // Buffer pool, huge pages fall back to transparent ones if none are reserved
+    Config::cfg.poolArenaMb = pt.get<size_t>("pool.arena_mb", 1024);
+    Config::cfg.poolHugePages = pt.get<bool>("pool.huge_pages", false);
+
+    // Trader
+    Config::cfg.sessionCount = pt.get<int>("trader.sessions", 1);
+    Config::cfg.hotTickers = pt.get<int>("trader.hot_tickers", 0);
+    Config::cfg.hotSharePct = pt.get<int>("trader.hot_share", 0);
+    Config::cfg.tradeMode = pt.get<std::string>("trader.mode", "timer");
+    Config::cfg.rngSeed = pt.get<uint64_t>("trader.seed", 0);
+
+    // Strategy of the trader sessions, sizes and spreads are in shares and price ticks
+    Config::cfg.strategy = pt.get<std::string>("strategy.name", "random");
+    Config::cfg.quoteSize = pt.get<uint32_t>("strategy.quote_size", 100);
+    Config::cfg.quoteSpread = pt.get<uint32_t>("strategy.quote_spread", 10);
+    Config::cfg.maxPosition = pt.get<uint32_t>("strategy.max_position", 10000);
+    Config::cfg.momentumBp = pt.get<uint32_t>("strategy.momentum_bp", 5);
+    Config::cfg.replayFile = pt.get<std::string>("strategy.replay_file", "replay.csv");
   }
 #else
   static void readConfig() {
@@ -23,8 +23,11 @@ namespace hft::db {
  */
 class PostgresAdapter {
 public:
+  static constexpr const char *CONNECTION =
+      "dbname=hft_db user=postgres password=password host=127.0.0.1 port=5432";
+
   static std::vector<TickerPrice> readTickers() {
-    pqxx::connection conn("dbname=hft_db user=postgres password=password host=127.0.0.1 port=5432");
+    pqxx::connection conn(CONNECTION);
     if (!conn.is_open()) {
       spdlog::error("Failed to open db");
       assert(false);
@@ -50,26 +53,23 @@ public:
     return tickers;
   }
 
+  /**
+   * @brief Single COPY for the whole batch instead of a statement per row
+   */
   static void generateABunchOfTickers(uint16_t size) {
-    pqxx::connection pgConn(
-        "dbname=hft_db user=postgres password=password host=127.0.0.1 port=5432");
+    pqxx::connection pgConn(CONNECTION);
     if (!pgConn.is_open()) {
       spdlog::error("Failed to connect to postgres");
       assert(false);
       return;
     }
     pqxx::work pgWork(pgConn);
-
-    std::stringstream query;
-    query << "INSERT INTO tickers (ticker, price) VALUES ";
-
+    auto stream = pqxx::stream_to::table(pgWork, {"tickers"}, {"ticker", "price"});
     for (int i = 0; i < size; ++i) {
       TickerPrice ticker = utils::generateTickerPrice();
-      std::string tickerStr(ticker.ticker.begin(), ticker.ticker.end());
-
-      pgWork.exec_params("INSERT INTO tickers (ticker, price) VALUES ($1, $2)", tickerStr,
-                         ticker.price);
+      stream.write_values(std::string_view(ticker.ticker.data(), TICKER_SIZE), ticker.price);
     }
+    stream.complete();
     pgWork.commit();
   }
 };
@@ -0,0 +1,98 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-12
+ */
+
+#ifndef HFT_COMMON_DB_TICKERFILE_HPP
+#define HFT_COMMON_DB_TICKERFILE_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "market_types.hpp"
+#include "types.hpp"
+
+namespace hft::db {
+
+/**
+ * @brief Binary ticker universe, a header followed by the raw TickerPrice array
+ * Loading is a single mmap and a copy, no parsing
+ */
+class TickerFile {
+  static constexpr uint32_t MAGIC = 0x54544648; // HFTT
+  static constexpr uint32_t VERSION = 2;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+  };
+  static_assert(std::is_trivially_copyable_v<TickerPrice>);
+
+public:
+  static void write(const std::string &path, const std::vector<TickerPrice> &tickers) {
+    const auto tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) {
+      throw std::runtime_error(std::format("Failed to create {}", tmpPath));
+    }
+    Header header{MAGIC, VERSION, tickers.size()};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && (tickers.empty() || fwrite(tickers.data(), sizeof(TickerPrice), tickers.size(),
+                                          file) == tickers.size());
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    fclose(file);
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+      std::remove(tmpPath.c_str());
+      throw std::runtime_error(std::format("Failed to write {}", path));
+    }
+  }
+
+  static std::vector<TickerPrice> read(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      throw std::runtime_error(std::format("Failed to open ticker file {}", path));
+    }
+    struct stat info{};
+    fstat(fd, &info);
+    const size_t size = info.st_size;
+    if (size < sizeof(Header)) {
+      close(fd);
+      throw std::runtime_error(std::format("Invalid ticker file {}", path));
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error(std::format("Failed to map ticker file {}", path));
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    const bool valid = header.magic == MAGIC && header.version == VERSION &&
+                       header.count <= (size - sizeof(Header)) / sizeof(TickerPrice);
+    std::vector<TickerPrice> tickers;
+    if (valid) {
+      tickers.resize(header.count);
+      std::memcpy(tickers.data(), static_cast<const std::byte *>(data) + sizeof(Header),
+                  header.count * sizeof(TickerPrice));
+    }
+    munmap(data, size);
+    if (!valid) {
+      throw std::runtime_error(std::format("Invalid ticker file {}", path));
+    }
+    return tickers;
+  }
+};
+
+} // namespace hft::db
+
+#endif // HFT_COMMON_DB_TICKERFILE_HPP
@@ -0,0 +1,65 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-12
+ */
+
+#ifndef HFT_COMMON_DB_TICKERPROVIDER_HPP
+#define HFT_COMMON_DB_TICKERPROVIDER_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "config/config.hpp"
+#include "market_types.hpp"
+#include "postgres_adapter.hpp"
+#include "ticker_file.hpp"
+#include "types.hpp"
+
+namespace hft::db {
+
+/**
+ * @brief Source of the ticker universe, selected by market_data.source in the config
+ */
+class TickerProvider {
+public:
+  using UPtr = std::unique_ptr<TickerProvider>;
+
+  virtual ~TickerProvider() = default;
+  virtual std::vector<TickerPrice> readTickers() = 0;
+
+  static UPtr create();
+};
+
+class PostgresTickerProvider : public TickerProvider {
+public:
+  std::vector<TickerPrice> readTickers() override { return PostgresAdapter::readTickers(); }
+};
+
+/**
+ * @brief Reads the file written by hft_ticker_export
+ */
+class FileTickerProvider : public TickerProvider {
+public:
+  explicit FileTickerProvider(const std::string &path) : mPath{path} {}
+
+  std::vector<TickerPrice> readTickers() override { return TickerFile::read(mPath); }
+
+private:
+  const std::string mPath;
+};
+
+inline TickerProvider::UPtr TickerProvider::create() {
+  if (Config::cfg.tickerSource == "file") {
+    return std::make_unique<FileTickerProvider>(Config::cfg.tickerFile);
+  }
+  if (Config::cfg.tickerSource == "postgres") {
+    return std::make_unique<PostgresTickerProvider>();
+  }
+  throw std::runtime_error(std::format("Unknown ticker source {}", Config::cfg.tickerSource));
+}
+
+} // namespace hft::db
+
+#endif // HFT_COMMON_DB_TICKERPROVIDER_HPP
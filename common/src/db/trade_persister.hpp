@@ -0,0 +1,200 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-13
+ */
+
+#ifndef HFT_COMMON_DB_TRADEPERSISTER_HPP
+#define HFT_COMMON_DB_TRADEPERSISTER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <pqxx/pqxx>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "constants.hpp"
+#include "logger.hpp"
+#include "market_types.hpp"
+#include "postgres_adapter.hpp"
+#include "template_types.hpp"
+#include "types.hpp"
+
+namespace hft::db {
+
+/**
+ * @brief Destination of persisted fills, written in batches from the persister thread
+ */
+class TradeSink {
+public:
+  using UPtr = std::unique_ptr<TradeSink>;
+
+  virtual ~TradeSink() = default;
+  virtual void write(const std::vector<OrderStatus> &trades) = 0;
+};
+
+/**
+ * @brief Streams every batch with COPY in its own transaction
+ */
+class PostgresTradeSink : public TradeSink {
+public:
+  PostgresTradeSink() : mConn{PostgresAdapter::CONNECTION} {
+    pqxx::work txn(mConn);
+    txn.exec("CREATE TABLE IF NOT EXISTS trades (trader_id INTEGER, order_id BIGINT, "
+             "ticker VARCHAR(4), quantity INTEGER, price INTEGER, action SMALLINT, "
+             "state SMALLINT)");
+    txn.commit();
+  }
+
+  void write(const std::vector<OrderStatus> &trades) override {
+    pqxx::work txn(mConn);
+    auto stream = pqxx::stream_to::table(
+        txn, {"trades"},
+        {"trader_id", "order_id", "ticker", "quantity", "price", "action", "state"});
+    for (auto &trade : trades) {
+      stream.write_values(trade.traderId, trade.id,
+                          std::string_view(trade.ticker.data(), TICKER_SIZE), trade.quantity,
+                          trade.fillPrice, static_cast<int16_t>(trade.action),
+                          static_cast<int16_t>(trade.state));
+    }
+    stream.complete();
+    txn.commit();
+  }
+
+private:
+  pqxx::connection mConn;
+};
+
+/**
+ * @brief Stand-in for Postgres, one csv line per fill
+ */
+class FileTradeSink : public TradeSink {
+public:
+  explicit FileTradeSink(const std::string &path) : mFile{path, std::ios::app} {
+    if (!mFile.is_open()) {
+      throw std::runtime_error(std::format("Failed to open trade file {}", path));
+    }
+  }
+
+  void write(const std::vector<OrderStatus> &trades) override {
+    for (auto &trade : trades) {
+      mFile << trade.traderId << ',' << trade.id << ','
+            << std::string_view(trade.ticker.data(), TICKER_SIZE) << ',' << trade.quantity << ','
+            << trade.fillPrice << ',' << static_cast<int>(trade.action) << ','
+            << static_cast<int>(trade.state) << '\n';
+    }
+    mFile.flush();
+  }
+
+private:
+  std::ofstream mFile;
+};
+
+/**
+ * @brief Moves fills off the matching threads. Workers push into a lock free queue and
+ * never wait, a full queue drops the fill and counts it, so drops and the queue depth
+ * high water mark tell how far the sink is behind
+ */
+class TradePersister {
+  static constexpr auto IDLE_SLEEP = std::chrono::milliseconds(1);
+
+public:
+  using UPtr = std::unique_ptr<TradePersister>;
+
+  struct Stats {
+    size_t pushed;
+    size_t dropped;
+    size_t written;
+    size_t failed;
+    size_t maxDepth;
+
+    size_t pending() const { return pushed > written + failed ? pushed - written - failed : 0; }
+  };
+
+  TradePersister(TradeSink::UPtr sink, size_t queueSize, size_t batchSize)
+      : mSink{std::move(sink)}, mQueue{createLFQueue<OrderStatus>(queueSize)},
+        mBatchSize{batchSize} {
+    mBatch.reserve(mBatchSize);
+    mThread = std::thread([this]() { run(); });
+  }
+
+  ~TradePersister() {
+    mRunning.store(false, std::memory_order_release);
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+  }
+
+  inline void push(const OrderStatus &trade) {
+    if (mQueue->bounded_push(trade)) {
+      mPushed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  Stats stats() const {
+    return Stats{mPushed.load(std::memory_order_relaxed),
+                 mDropped.load(std::memory_order_relaxed),
+                 mWritten.load(std::memory_order_relaxed), mFailed.load(std::memory_order_relaxed),
+                 mMaxDepth.load(std::memory_order_relaxed)};
+  }
+
+private:
+  void run() {
+    while (true) {
+      const bool running = mRunning.load(std::memory_order_acquire);
+      OrderStatus trade;
+      while (mBatch.size() < mBatchSize && mQueue->pop(trade)) {
+        mBatch.push_back(trade);
+      }
+      if (!mBatch.empty()) {
+        flush();
+      } else if (!running) {
+        break;
+      } else {
+        std::this_thread::sleep_for(IDLE_SLEEP);
+      }
+    }
+  }
+
+  void flush() {
+    // Pushed is counted after the push, so it may briefly lag behind what was popped
+    const size_t depth = stats().pending();
+    if (depth > mMaxDepth.load(std::memory_order_relaxed)) {
+      mMaxDepth.store(depth, std::memory_order_relaxed);
+    }
+    try {
+      mSink->write(mBatch);
+      mWritten.fetch_add(mBatch.size(), std::memory_order_relaxed);
+    } catch (const std::exception &e) {
+      mFailed.fetch_add(mBatch.size(), std::memory_order_relaxed);
+      spdlog::error("Failed to persist {} trades: {}", mBatch.size(), e.what());
+    }
+    mBatch.clear();
+  }
+
+private:
+  TradeSink::UPtr mSink;
+  UPtrLFQueue<OrderStatus> mQueue;
+  const size_t mBatchSize;
+  std::vector<OrderStatus> mBatch;
+
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mPushed{0};
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mDropped{0};
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mWritten{0};
+  std::atomic_size_t mFailed{0};
+  std::atomic_size_t mMaxDepth{0};
+
+  std::atomic_bool mRunning{true};
+  std::thread mThread;
+};
+
+} // namespace hft::db
+
+#endif // HFT_COMMON_DB_TRADEPERSISTER_HPP
@@ -30,6 +30,14 @@ struct TickerPrice;
 struct TickerPriceBuilder;
 struct TickerPriceT;
 
+struct LoginRequest;
+struct LoginRequestBuilder;
+struct LoginRequestT;
+
+struct LoginResponse;
+struct LoginResponseBuilder;
+struct LoginResponseT;
+
 enum OrderAction : int8_t {
   OrderAction_BUY = 0,
   OrderAction_SELL = 1,
@@ -65,38 +73,144 @@ enum OrderState : int32_t {
   OrderState_Partial = 1,
   OrderState_Full = 2,
   OrderState_Instant = 4,
+  OrderState_Rejected = 8,
+  OrderState_Cancelled = 16,
+  OrderState_Resting = 32,
   OrderState_MIN = OrderState_Accepted,
-  OrderState_MAX = OrderState_Instant
+  OrderState_MAX = OrderState_Resting
 };
 
-inline const OrderState (&EnumValuesOrderState())[4] {
+inline const OrderState (&EnumValuesOrderState())[7] {
   static const OrderState values[] = {
     OrderState_Accepted,
     OrderState_Partial,
     OrderState_Full,
-    OrderState_Instant
+    OrderState_Instant,
+    OrderState_Rejected,
+    OrderState_Cancelled,
+    OrderState_Resting
   };
   return values;
 }
 
 inline const char * const *EnumNamesOrderState() {
-  static const char * const names[6] = {
+  static const char * const names[34] = {
     "Accepted",
     "Partial",
     "Full",
     "",
     "Instant",
+    "",
+    "",
+    "",
+    "Rejected",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "Cancelled",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "Resting",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameOrderState(OrderState e) {
-  if (flatbuffers::IsOutRange(e, OrderState_Accepted, OrderState_Instant)) return "";
+  if (flatbuffers::IsOutRange(e, OrderState_Accepted, OrderState_Resting)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesOrderState()[index];
 }
 
+enum OrderType : int8_t {
+  OrderType_LIMIT = 0,
+  OrderType_MARKET = 1,
+  OrderType_POST_ONLY = 2,
+  OrderType_STOP = 3,
+  OrderType_STOP_LIMIT = 4,
+  OrderType_MIN = OrderType_LIMIT,
+  OrderType_MAX = OrderType_STOP_LIMIT
+};
+
+inline const OrderType (&EnumValuesOrderType())[5] {
+  static const OrderType values[] = {
+    OrderType_LIMIT,
+    OrderType_MARKET,
+    OrderType_POST_ONLY,
+    OrderType_STOP,
+    OrderType_STOP_LIMIT
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesOrderType() {
+  static const char * const names[6] = {
+    "LIMIT",
+    "MARKET",
+    "POST_ONLY",
+    "STOP",
+    "STOP_LIMIT",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameOrderType(OrderType e) {
+  if (flatbuffers::IsOutRange(e, OrderType_LIMIT, OrderType_STOP_LIMIT)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesOrderType()[index];
+}
+
+enum TimeInForce : int8_t {
+  TimeInForce_GTC = 0,
+  TimeInForce_IOC = 1,
+  TimeInForce_FOK = 2,
+  TimeInForce_MIN = TimeInForce_GTC,
+  TimeInForce_MAX = TimeInForce_FOK
+};
+
+inline const TimeInForce (&EnumValuesTimeInForce())[3] {
+  static const TimeInForce values[] = {
+    TimeInForce_GTC,
+    TimeInForce_IOC,
+    TimeInForce_FOK
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesTimeInForce() {
+  static const char * const names[4] = {
+    "GTC",
+    "IOC",
+    "FOK",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameTimeInForce(TimeInForce e) {
+  if (flatbuffers::IsOutRange(e, TimeInForce_GTC, TimeInForce_FOK)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesTimeInForce()[index];
+}
+
 struct OrderT : public flatbuffers::NativeTable {
   typedef Order TableType;
   uint32_t id = 0;
@@ -104,6 +218,10 @@ struct OrderT : public flatbuffers::NativeTable {
   uint32_t quantity = 0;
   uint32_t price = 0;
   hft::serialization::gen::fbs::OrderAction action = hft::serialization::gen::fbs::OrderAction_BUY;
+  hft::serialization::gen::fbs::OrderType type = hft::serialization::gen::fbs::OrderType_LIMIT;
+  hft::serialization::gen::fbs::TimeInForce tif = hft::serialization::gen::fbs::TimeInForce_GTC;
+  uint32_t display_quantity = 0;
+  uint32_t trigger_price = 0;
 };
 
 struct Order FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
@@ -114,7 +232,11 @@ struct Order FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_TICKER = 6,
     VT_QUANTITY = 8,
     VT_PRICE = 10,
-    VT_ACTION = 12
+    VT_ACTION = 12,
+    VT_TYPE = 14,
+    VT_TIF = 16,
+    VT_DISPLAY_QUANTITY = 18,
+    VT_TRIGGER_PRICE = 20
   };
   uint32_t id() const {
     return GetField<uint32_t>(VT_ID, 0);
@@ -131,6 +253,18 @@ struct Order FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   hft::serialization::gen::fbs::OrderAction action() const {
     return static_cast<hft::serialization::gen::fbs::OrderAction>(GetField<int8_t>(VT_ACTION, 0));
   }
+  hft::serialization::gen::fbs::OrderType type() const {
+    return static_cast<hft::serialization::gen::fbs::OrderType>(GetField<int8_t>(VT_TYPE, 0));
+  }
+  hft::serialization::gen::fbs::TimeInForce tif() const {
+    return static_cast<hft::serialization::gen::fbs::TimeInForce>(GetField<int8_t>(VT_TIF, 0));
+  }
+  uint32_t display_quantity() const {
+    return GetField<uint32_t>(VT_DISPLAY_QUANTITY, 0);
+  }
+  uint32_t trigger_price() const {
+    return GetField<uint32_t>(VT_TRIGGER_PRICE, 0);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<uint32_t>(verifier, VT_ID, 4) &&
@@ -139,6 +273,10 @@ struct Order FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyField<uint32_t>(verifier, VT_QUANTITY, 4) &&
            VerifyField<uint32_t>(verifier, VT_PRICE, 4) &&
            VerifyField<int8_t>(verifier, VT_ACTION, 1) &&
+           VerifyField<int8_t>(verifier, VT_TYPE, 1) &&
+           VerifyField<int8_t>(verifier, VT_TIF, 1) &&
+           VerifyField<uint32_t>(verifier, VT_DISPLAY_QUANTITY, 4) &&
+           VerifyField<uint32_t>(verifier, VT_TRIGGER_PRICE, 4) &&
            verifier.EndTable();
   }
   OrderT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -165,6 +303,18 @@ struct OrderBuilder {
   void add_action(hft::serialization::gen::fbs::OrderAction action) {
     fbb_.AddElement<int8_t>(Order::VT_ACTION, static_cast<int8_t>(action), 0);
   }
+  void add_type(hft::serialization::gen::fbs::OrderType type) {
+    fbb_.AddElement<int8_t>(Order::VT_TYPE, static_cast<int8_t>(type), 0);
+  }
+  void add_tif(hft::serialization::gen::fbs::TimeInForce tif) {
+    fbb_.AddElement<int8_t>(Order::VT_TIF, static_cast<int8_t>(tif), 0);
+  }
+  void add_display_quantity(uint32_t display_quantity) {
+    fbb_.AddElement<uint32_t>(Order::VT_DISPLAY_QUANTITY, display_quantity, 0);
+  }
+  void add_trigger_price(uint32_t trigger_price) {
+    fbb_.AddElement<uint32_t>(Order::VT_TRIGGER_PRICE, trigger_price, 0);
+  }
   explicit OrderBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -182,12 +332,20 @@ inline flatbuffers::Offset<Order> CreateOrder(
     flatbuffers::Offset<flatbuffers::String> ticker = 0,
     uint32_t quantity = 0,
     uint32_t price = 0,
-    hft::serialization::gen::fbs::OrderAction action = hft::serialization::gen::fbs::OrderAction_BUY) {
+    hft::serialization::gen::fbs::OrderAction action = hft::serialization::gen::fbs::OrderAction_BUY,
+    hft::serialization::gen::fbs::OrderType type = hft::serialization::gen::fbs::OrderType_LIMIT,
+    hft::serialization::gen::fbs::TimeInForce tif = hft::serialization::gen::fbs::TimeInForce_GTC,
+    uint32_t display_quantity = 0,
+    uint32_t trigger_price = 0) {
   OrderBuilder builder_(_fbb);
+  builder_.add_trigger_price(trigger_price);
+  builder_.add_display_quantity(display_quantity);
   builder_.add_price(price);
   builder_.add_quantity(quantity);
   builder_.add_ticker(ticker);
   builder_.add_id(id);
+  builder_.add_tif(tif);
+  builder_.add_type(type);
   builder_.add_action(action);
   return builder_.Finish();
 }
@@ -198,7 +356,11 @@ inline flatbuffers::Offset<Order> CreateOrderDirect(
     const char *ticker = nullptr,
     uint32_t quantity = 0,
     uint32_t price = 0,
-    hft::serialization::gen::fbs::OrderAction action = hft::serialization::gen::fbs::OrderAction_BUY) {
+    hft::serialization::gen::fbs::OrderAction action = hft::serialization::gen::fbs::OrderAction_BUY,
+    hft::serialization::gen::fbs::OrderType type = hft::serialization::gen::fbs::OrderType_LIMIT,
+    hft::serialization::gen::fbs::TimeInForce tif = hft::serialization::gen::fbs::TimeInForce_GTC,
+    uint32_t display_quantity = 0,
+    uint32_t trigger_price = 0) {
   auto ticker__ = ticker ? _fbb.CreateString(ticker) : 0;
   return hft::serialization::gen::fbs::CreateOrder(
       _fbb,
@@ -206,7 +368,11 @@ inline flatbuffers::Offset<Order> CreateOrderDirect(
       ticker__,
       quantity,
       price,
-      action);
+      action,
+      type,
+      tif,
+      display_quantity,
+      trigger_price);
 }
 
 flatbuffers::Offset<Order> CreateOrder(flatbuffers::FlatBufferBuilder &_fbb, const OrderT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
@@ -342,6 +508,10 @@ struct TickerPriceT : public flatbuffers::NativeTable {
   typedef TickerPrice TableType;
   std::string ticker{};
   uint32_t price = 0;
+  uint32_t bid = 0;
+  uint32_t ask = 0;
+  uint32_t bid_quantity = 0;
+  uint32_t ask_quantity = 0;
 };
 
 struct TickerPrice FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
@@ -349,7 +519,11 @@ struct TickerPrice FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef TickerPriceBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_TICKER = 4,
-    VT_PRICE = 6
+    VT_PRICE = 6,
+    VT_BID = 8,
+    VT_ASK = 10,
+    VT_BID_QUANTITY = 12,
+    VT_ASK_QUANTITY = 14
   };
   const flatbuffers::String *ticker() const {
     return GetPointer<const flatbuffers::String *>(VT_TICKER);
@@ -357,11 +531,27 @@ struct TickerPrice FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   uint32_t price() const {
     return GetField<uint32_t>(VT_PRICE, 0);
   }
+  uint32_t bid() const {
+    return GetField<uint32_t>(VT_BID, 0);
+  }
+  uint32_t ask() const {
+    return GetField<uint32_t>(VT_ASK, 0);
+  }
+  uint32_t bid_quantity() const {
+    return GetField<uint32_t>(VT_BID_QUANTITY, 0);
+  }
+  uint32_t ask_quantity() const {
+    return GetField<uint32_t>(VT_ASK_QUANTITY, 0);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_TICKER) &&
            verifier.VerifyString(ticker()) &&
            VerifyField<uint32_t>(verifier, VT_PRICE, 4) &&
+           VerifyField<uint32_t>(verifier, VT_BID, 4) &&
+           VerifyField<uint32_t>(verifier, VT_ASK, 4) &&
+           VerifyField<uint32_t>(verifier, VT_BID_QUANTITY, 4) &&
+           VerifyField<uint32_t>(verifier, VT_ASK_QUANTITY, 4) &&
            verifier.EndTable();
   }
   TickerPriceT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -379,6 +569,18 @@ struct TickerPriceBuilder {
   void add_price(uint32_t price) {
     fbb_.AddElement<uint32_t>(TickerPrice::VT_PRICE, price, 0);
   }
+  void add_bid(uint32_t bid) {
+    fbb_.AddElement<uint32_t>(TickerPrice::VT_BID, bid, 0);
+  }
+  void add_ask(uint32_t ask) {
+    fbb_.AddElement<uint32_t>(TickerPrice::VT_ASK, ask, 0);
+  }
+  void add_bid_quantity(uint32_t bid_quantity) {
+    fbb_.AddElement<uint32_t>(TickerPrice::VT_BID_QUANTITY, bid_quantity, 0);
+  }
+  void add_ask_quantity(uint32_t ask_quantity) {
+    fbb_.AddElement<uint32_t>(TickerPrice::VT_ASK_QUANTITY, ask_quantity, 0);
+  }
   explicit TickerPriceBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -393,8 +595,16 @@ struct TickerPriceBuilder {
 inline flatbuffers::Offset<TickerPrice> CreateTickerPrice(
     flatbuffers::FlatBufferBuilder &_fbb,
     flatbuffers::Offset<flatbuffers::String> ticker = 0,
-    uint32_t price = 0) {
+    uint32_t price = 0,
+    uint32_t bid = 0,
+    uint32_t ask = 0,
+    uint32_t bid_quantity = 0,
+    uint32_t ask_quantity = 0) {
   TickerPriceBuilder builder_(_fbb);
+  builder_.add_ask_quantity(ask_quantity);
+  builder_.add_bid_quantity(bid_quantity);
+  builder_.add_ask(ask);
+  builder_.add_bid(bid);
   builder_.add_price(price);
   builder_.add_ticker(ticker);
   return builder_.Finish();
@@ -403,16 +613,150 @@ inline flatbuffers::Offset<TickerPrice> CreateTickerPrice(
 inline flatbuffers::Offset<TickerPrice> CreateTickerPriceDirect(
     flatbuffers::FlatBufferBuilder &_fbb,
     const char *ticker = nullptr,
-    uint32_t price = 0) {
+    uint32_t price = 0,
+    uint32_t bid = 0,
+    uint32_t ask = 0,
+    uint32_t bid_quantity = 0,
+    uint32_t ask_quantity = 0) {
   auto ticker__ = ticker ? _fbb.CreateString(ticker) : 0;
   return hft::serialization::gen::fbs::CreateTickerPrice(
       _fbb,
       ticker__,
-      price);
+      price,
+      bid,
+      ask,
+      bid_quantity,
+      ask_quantity);
 }
 
 flatbuffers::Offset<TickerPrice> CreateTickerPrice(flatbuffers::FlatBufferBuilder &_fbb, const TickerPriceT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct LoginRequestT : public flatbuffers::NativeTable {
+  typedef LoginRequest TableType;
+  uint32_t trader_id = 0;
+  uint64_t token = 0;
+};
+
+struct LoginRequest FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef LoginRequestT NativeTableType;
+  typedef LoginRequestBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_TRADER_ID = 4,
+    VT_TOKEN = 6
+  };
+  uint32_t trader_id() const {
+    return GetField<uint32_t>(VT_TRADER_ID, 0);
+  }
+  uint64_t token() const {
+    return GetField<uint64_t>(VT_TOKEN, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_TRADER_ID, 4) &&
+           VerifyField<uint64_t>(verifier, VT_TOKEN, 8) &&
+           verifier.EndTable();
+  }
+  LoginRequestT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(LoginRequestT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<LoginRequest> Pack(flatbuffers::FlatBufferBuilder &_fbb, const LoginRequestT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct LoginRequestBuilder {
+  typedef LoginRequest Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_trader_id(uint32_t trader_id) {
+    fbb_.AddElement<uint32_t>(LoginRequest::VT_TRADER_ID, trader_id, 0);
+  }
+  void add_token(uint64_t token) {
+    fbb_.AddElement<uint64_t>(LoginRequest::VT_TOKEN, token, 0);
+  }
+  explicit LoginRequestBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  flatbuffers::Offset<LoginRequest> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<LoginRequest>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LoginRequest> CreateLoginRequest(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t trader_id = 0,
+    uint64_t token = 0) {
+  LoginRequestBuilder builder_(_fbb);
+  builder_.add_token(token);
+  builder_.add_trader_id(trader_id);
+  return builder_.Finish();
+}
+
+flatbuffers::Offset<LoginRequest> CreateLoginRequest(flatbuffers::FlatBufferBuilder &_fbb, const LoginRequestT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct LoginResponseT : public flatbuffers::NativeTable {
+  typedef LoginResponse TableType;
+  uint32_t trader_id = 0;
+  uint64_t token = 0;
+};
+
+struct LoginResponse FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef LoginResponseT NativeTableType;
+  typedef LoginResponseBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_TRADER_ID = 4,
+    VT_TOKEN = 6
+  };
+  uint32_t trader_id() const {
+    return GetField<uint32_t>(VT_TRADER_ID, 0);
+  }
+  uint64_t token() const {
+    return GetField<uint64_t>(VT_TOKEN, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_TRADER_ID, 4) &&
+           VerifyField<uint64_t>(verifier, VT_TOKEN, 8) &&
+           verifier.EndTable();
+  }
+  LoginResponseT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(LoginResponseT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<LoginResponse> Pack(flatbuffers::FlatBufferBuilder &_fbb, const LoginResponseT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct LoginResponseBuilder {
+  typedef LoginResponse Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_trader_id(uint32_t trader_id) {
+    fbb_.AddElement<uint32_t>(LoginResponse::VT_TRADER_ID, trader_id, 0);
+  }
+  void add_token(uint64_t token) {
+    fbb_.AddElement<uint64_t>(LoginResponse::VT_TOKEN, token, 0);
+  }
+  explicit LoginResponseBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  flatbuffers::Offset<LoginResponse> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<LoginResponse>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LoginResponse> CreateLoginResponse(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t trader_id = 0,
+    uint64_t token = 0) {
+  LoginResponseBuilder builder_(_fbb);
+  builder_.add_token(token);
+  builder_.add_trader_id(trader_id);
+  return builder_.Finish();
+}
+
+flatbuffers::Offset<LoginResponse> CreateLoginResponse(flatbuffers::FlatBufferBuilder &_fbb, const LoginResponseT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 inline OrderT *Order::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   auto _o = std::unique_ptr<OrderT>(new OrderT());
   UnPackTo(_o.get(), _resolver);
@@ -427,6 +771,10 @@ inline void Order::UnPackTo(OrderT *_o, const flatbuffers::resolver_function_t *
   { auto _e = quantity(); _o->quantity = _e; }
   { auto _e = price(); _o->price = _e; }
   { auto _e = action(); _o->action = _e; }
+  { auto _e = type(); _o->type = _e; }
+  { auto _e = tif(); _o->tif = _e; }
+  { auto _e = display_quantity(); _o->display_quantity = _e; }
+  { auto _e = trigger_price(); _o->trigger_price = _e; }
 }
 
 inline flatbuffers::Offset<Order> Order::Pack(flatbuffers::FlatBufferBuilder &_fbb, const OrderT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
@@ -442,13 +790,21 @@ inline flatbuffers::Offset<Order> CreateOrder(flatbuffers::FlatBufferBuilder &_f
   auto _quantity = _o->quantity;
   auto _price = _o->price;
   auto _action = _o->action;
+  auto _type = _o->type;
+  auto _tif = _o->tif;
+  auto _display_quantity = _o->display_quantity;
+  auto _trigger_price = _o->trigger_price;
   return hft::serialization::gen::fbs::CreateOrder(
       _fbb,
       _id,
       _ticker,
       _quantity,
       _price,
-      _action);
+      _action,
+      _type,
+      _tif,
+      _display_quantity,
+      _trigger_price);
 }
 
 inline OrderStatusT *OrderStatus::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
@@ -503,6 +859,10 @@ inline void TickerPrice::UnPackTo(TickerPriceT *_o, const flatbuffers::resolver_
   (void)_resolver;
   { auto _e = ticker(); if (_e) _o->ticker = _e->str(); }
   { auto _e = price(); _o->price = _e; }
+  { auto _e = bid(); _o->bid = _e; }
+  { auto _e = ask(); _o->ask = _e; }
+  { auto _e = bid_quantity(); _o->bid_quantity = _e; }
+  { auto _e = ask_quantity(); _o->ask_quantity = _e; }
 }
 
 inline flatbuffers::Offset<TickerPrice> TickerPrice::Pack(flatbuffers::FlatBufferBuilder &_fbb, const TickerPriceT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
@@ -515,10 +875,76 @@ inline flatbuffers::Offset<TickerPrice> CreateTickerPrice(flatbuffers::FlatBuffe
   struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const TickerPriceT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
   auto _ticker = _o->ticker.empty() ? 0 : _fbb.CreateString(_o->ticker);
   auto _price = _o->price;
+  auto _bid = _o->bid;
+  auto _ask = _o->ask;
+  auto _bid_quantity = _o->bid_quantity;
+  auto _ask_quantity = _o->ask_quantity;
   return hft::serialization::gen::fbs::CreateTickerPrice(
       _fbb,
       _ticker,
-      _price);
+      _price,
+      _bid,
+      _ask,
+      _bid_quantity,
+      _ask_quantity);
+}
+
+inline LoginRequestT *LoginRequest::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<LoginRequestT>(new LoginRequestT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void LoginRequest::UnPackTo(LoginRequestT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = trader_id(); _o->trader_id = _e; }
+  { auto _e = token(); _o->token = _e; }
+}
+
+inline flatbuffers::Offset<LoginRequest> LoginRequest::Pack(flatbuffers::FlatBufferBuilder &_fbb, const LoginRequestT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateLoginRequest(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<LoginRequest> CreateLoginRequest(flatbuffers::FlatBufferBuilder &_fbb, const LoginRequestT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const LoginRequestT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _trader_id = _o->trader_id;
+  auto _token = _o->token;
+  return hft::serialization::gen::fbs::CreateLoginRequest(
+      _fbb,
+      _trader_id,
+      _token);
+}
+
+inline LoginResponseT *LoginResponse::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = std::unique_ptr<LoginResponseT>(new LoginResponseT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void LoginResponse::UnPackTo(LoginResponseT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = trader_id(); _o->trader_id = _e; }
+  { auto _e = token(); _o->token = _e; }
+}
+
+inline flatbuffers::Offset<LoginResponse> LoginResponse::Pack(flatbuffers::FlatBufferBuilder &_fbb, const LoginResponseT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateLoginResponse(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<LoginResponse> CreateLoginResponse(flatbuffers::FlatBufferBuilder &_fbb, const LoginResponseT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const LoginResponseT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _trader_id = _o->trader_id;
+  auto _token = _o->token;
+  return hft::serialization::gen::fbs::CreateLoginResponse(
+      _fbb,
+      _trader_id,
+      _token);
 }
 
 }  // namespace fbs
@@ -14,6 +14,7 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include "binary_logger.hpp"
 #include "utils/string_utils.hpp"
 
 namespace hft {
@@ -21,6 +22,8 @@ namespace hft {
 /**
  * @brief By switching to a monitoring mode main logger gets disabled
  * and logs written via logService get to console via a separate logger
+ * Binary backend serves HFT_LOG_* macros and shares the rotating file with the main logger,
+ * with the spdlog backend the macros format right away and go to the main logger
  */
 class Logger {
 public:
@@ -29,37 +32,53 @@ public:
   using LogLevel = spdlog::level::level_enum;
   using SPtrSpdLogger = std::shared_ptr<spdlog::logger>;
 
+  enum class Backend : uint8_t { Spdlog, Binary };
+
   static SPtrSpdLogger mainLogger;
   static SPtrSpdLogger monitorLogger;
 
-  static void initialize(LogLevel logLvl, const std::string &fileName = "") {
+  static void initialize(LogLevel logLvl, const std::string &fileName = "",
+                         Backend backend = Backend::Spdlog) {
     initMonitorLogger();
     initMainLogger(fileName);
-    spdlog::set_level(logLvl);
+    if (backend == Backend::Binary) {
+      BinaryLogger::start(mainLogger->sinks().front());
+    }
+    setLevel(logLvl);
     spdlog::flush_on(spdlog::level::err);
   }
 
+  static void shutdown() {
+    BinaryLogger::stop();
+    spdlog::default_logger()->flush();
+  }
+
+  static void setLevel(LogLevel logLvl) {
+    spdlog::set_level(logLvl);
+    BinaryLogger::setLevel(logLvl);
+  }
+
   static void switchLogLevel(bool goUp) {
     using namespace spdlog::level;
     level_enum currentLvl = spdlog::get_level();
     switch (currentLvl) {
     case level_enum::trace:
-      spdlog::set_level(goUp ? level_enum::trace : level_enum::debug);
+      setLevel(goUp ? level_enum::trace : level_enum::debug);
       break;
     case level_enum::debug:
-      spdlog::set_level(goUp ? level_enum::trace : level_enum::info);
+      setLevel(goUp ? level_enum::trace : level_enum::info);
       break;
     case level_enum::info:
-      spdlog::set_level(goUp ? level_enum::debug : level_enum::warn);
+      setLevel(goUp ? level_enum::debug : level_enum::warn);
       break;
     case level_enum::warn:
-      spdlog::set_level(goUp ? level_enum::info : level_enum::err);
+      setLevel(goUp ? level_enum::info : level_enum::err);
       break;
     case level_enum::err:
-      spdlog::set_level(goUp ? level_enum::warn : level_enum::critical);
+      setLevel(goUp ? level_enum::warn : level_enum::critical);
       break;
     case level_enum::critical:
-      spdlog::set_level(goUp ? level_enum::err : level_enum::critical);
+      setLevel(goUp ? level_enum::err : level_enum::critical);
       break;
     case level_enum::off:
       // monitor mode
@@ -80,12 +99,12 @@ private:
     spdlog::init_thread_pool(8192, 1);
     auto rotatingSink =
         std::make_shared<spdlog::sinks::rotating_file_sink_mt>(filename, 25 * 1024 * 1024, 3);
-    auto kMainLogger = std::make_shared<spdlog::async_logger>(
+    mainLogger = std::make_shared<spdlog::async_logger>(
         "async_file_logger", rotatingSink, spdlog::thread_pool(),
         spdlog::async_overflow_policy::overrun_oldest);
-    kMainLogger->set_pattern(kPattern);
-    spdlog::register_logger(kMainLogger);
-    spdlog::set_default_logger(kMainLogger);
+    mainLogger->set_pattern(kPattern);
+    spdlog::register_logger(mainLogger);
+    spdlog::set_default_logger(mainLogger);
   }
 };
 
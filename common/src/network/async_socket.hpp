@@ -8,6 +8,7 @@
 
 #include <boost/endian/arithmetic.hpp>
 #include <boost/endian/conversion.hpp>
+#include <chrono>
 #include <memory>
 #include <spdlog/spdlog.h>
 #include <vector>
@@ -64,6 +65,12 @@ public:
   }
 
   void asyncRead() {
+    if constexpr (std::is_same_v<Socket, UdpSocket>) {
+      // Every datagram holds whole messages, so each is received from the buffer start
+      // and a datagram cut by a smaller window can't be glued to the next one
+      static_assert(BUFFER_SIZE >= UDP_DATAGRAM_SIZE);
+      mHead = mTail = 0;
+    }
     size_t writable = mReadBuffer.size() - mTail;
     uint8_t *writePtr = mReadBuffer.data() + mTail;
 
@@ -80,54 +87,57 @@ public:
 
   template <typename MessageTypeOut>
   void asyncWrite(Span<MessageTypeOut> msgVec) {
-    size_t allocSize = msgVec.size() * MAX_SERIALIZED_MESSAGE_SIZE;
-    auto dataPtr = std::make_unique<ByteBuffer>(allocSize);
-
-    size_t totalSize{0};
-    uint8_t *cursor = dataPtr->data();
-    for (auto &msg : msgVec) {
-      auto msgSize = serializeMessage(msg, cursor);
-      cursor += msgSize;
-      totalSize += msgSize;
-    }
-
     if constexpr (std::is_same_v<Socket, TcpSocket>) {
-      boost::asio::async_write(mSocket, boost::asio::buffer(dataPtr->data(), totalSize),
+      size_t allocSize = msgVec.size() * MAX_SERIALIZED_MESSAGE_SIZE;
+      auto dataPtr = makePoolBuffer(allocSize);
+
+      size_t totalSize{0};
+      uint8_t *cursor = dataPtr.get();
+      for (auto &msg : msgVec) {
+        auto msgSize = serializeMessage(msg, cursor);
+        cursor += msgSize;
+        totalSize += msgSize;
+      }
+      boost::asio::async_write(mSocket, boost::asio::buffer(dataPtr.get(), totalSize),
                                [this, data = std::move(dataPtr)](BoostErrorRef ec, size_t size) {
                                  if (ec) {
                                    spdlog::error("Write failed: {}", ec.message());
                                  }
                                });
     } else if constexpr (std::is_same_v<Socket, UdpSocket>) {
-      mSocket.async_send_to(boost::asio::buffer(dataPtr->data(), totalSize), mEndpoint,
-                            [this, data = std::move(dataPtr)](BoostErrorRef ec, size_t size) {
-                              if (ec) {
-                                spdlog::error("Write failed: {}", ec.message());
-                              }
-                            });
+      writeDatagrams(msgVec);
     }
   }
 
-private:
-  template <typename Type>
-  boost::endian::little_int16_at serializeMessage(Type &msg, uint8_t *cursor) {
-    auto buffer = Serializer::serialize(msg);
-    boost::endian::little_int16_at bodySize = static_cast<MessageSize>(buffer.size());
+  /**
+   * @brief Called once reading stops on an error or end of stream, the socket is not
+   * read again. Runs inside the read handler, so it must not destroy the socket
+   */
+  void setCloseHandler(Callback handler) { mCloseHandler = std::move(handler); }
 
-    std::memcpy(cursor, &bodySize, sizeof(bodySize));
-    std::memcpy(cursor + sizeof(bodySize), buffer.data(), buffer.size());
+  /**
+   * @brief Cancels pending operations, their handlers still run on the socket context
+   */
+  void close() {
+    BoostError ec;
+    mSocket.close(ec);
+  }
 
-    return bodySize + sizeof(bodySize);
+  /**
+   * @brief Steady clock nanoseconds when the last datagram came in, valid in the message
+   * handler. Stream sockets do not stamp reads
+   */
+  uint64_t readTime() const { return mReadTime; }
+
+  /**
+   * @brief Write window of the read buffer and framing of bytes that landed in it, the part
+   * of every read that does not touch the socket. Lets framing run over prebuilt buffers
+   */
+  Span<uint8_t> readSpace() {
+    return Span<uint8_t>(mReadBuffer.data() + mTail, mReadBuffer.size() - mTail);
   }
 
-  void readHandler(BoostErrorRef ec, size_t bytesRead) {
-    if (ec) {
-      mHead = mTail = 0;
-      if (ec != boost::asio::error::eof) {
-        spdlog::error(ec.message());
-      }
-      return;
-    }
+  void consume(size_t bytesRead) {
     mTail += bytesRead;
     while (mHead + sizeof(MessageSize) < mTail) {
       uint8_t *cursor = mReadBuffer.data() + mHead;
@@ -148,7 +158,7 @@ private:
         mHead = mTail = 0;
         break;
       }
-      if constexpr (!std::is_same_v<MessageTypeIn, TickerPrice>) {
+      if constexpr (std::is_same_v<MessageTypeIn, Order>) {
         result.value.traderId = mId;
       }
       mHandler(result.value);
@@ -157,6 +167,69 @@ private:
     if (mReadBuffer.size() - mTail < 256) {
       rotateBuffer();
     }
+  }
+
+private:
+  /**
+   * @brief Messages are packed into datagrams that fit the MTU and none is split between
+   * two, reader receives every datagram whole into an empty buffer
+   */
+  template <typename MessageTypeOut>
+  void writeDatagrams(Span<MessageTypeOut> msgVec) {
+    PoolBuffer dataPtr;
+    size_t totalSize{0};
+    for (auto &msg : msgVec) {
+      if (totalSize + MAX_SERIALIZED_MESSAGE_SIZE > UDP_DATAGRAM_SIZE) {
+        sendDatagram(std::move(dataPtr), totalSize);
+        totalSize = 0;
+      }
+      if (dataPtr == nullptr) {
+        dataPtr = makePoolBuffer(UDP_DATAGRAM_SIZE);
+      }
+      totalSize += serializeMessage(msg, dataPtr.get() + totalSize);
+    }
+    if (totalSize != 0) {
+      sendDatagram(std::move(dataPtr), totalSize);
+    }
+  }
+
+  void sendDatagram(PoolBuffer dataPtr, size_t size) {
+    mSocket.async_send_to(boost::asio::buffer(dataPtr.get(), size), mEndpoint,
+                          [this, data = std::move(dataPtr)](BoostErrorRef ec, size_t size) {
+                            if (ec) {
+                              spdlog::error("Write failed: {}", ec.message());
+                            }
+                          });
+  }
+
+  template <typename Type>
+  boost::endian::little_int16_at serializeMessage(Type &msg, uint8_t *cursor) {
+    auto buffer = Serializer::serialize(msg);
+    boost::endian::little_int16_at bodySize = static_cast<MessageSize>(buffer.size());
+
+    std::memcpy(cursor, &bodySize, sizeof(bodySize));
+    std::memcpy(cursor + sizeof(bodySize), buffer.data(), buffer.size());
+
+    return bodySize + sizeof(bodySize);
+  }
+
+  void readHandler(BoostErrorRef ec, size_t bytesRead) {
+    if constexpr (std::is_same_v<Socket, UdpSocket>) {
+      mReadTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+    }
+    if (ec) {
+      mHead = mTail = 0;
+      if (ec != boost::asio::error::eof && ec != boost::asio::error::operation_aborted) {
+        spdlog::error(ec.message());
+      }
+      if (mCloseHandler) {
+        mCloseHandler();
+      }
+      return;
+    }
+    consume(bytesRead);
     asyncRead();
   }
 
@@ -170,11 +243,13 @@ private:
   Socket mSocket;
   Endpoint mEndpoint;
   MsgHandler mHandler;
+  Callback mCloseHandler;
 
   size_t mHead{0};
   size_t mTail{0};
   ByteBuffer mReadBuffer;
   TraderId mId{};
+  uint64_t mReadTime{0};
 };
 
 } // namespace hft
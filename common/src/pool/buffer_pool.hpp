@@ -6,63 +6,417 @@
 #ifndef HFT_COMMON_BUFFERPOOL_HPP
 #define HFT_COMMON_BUFFERPOOL_HPP
 
+#include <sys/mman.h>
+
+#include <array>
 #include <atomic>
-#include <boost/lockfree/queue.hpp>
+#include <bit>
 #include <cstdlib>
-#include <spdlog/spdlog.h>
-#include <thread>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
 #include <vector>
 
-#include "template_types.hpp"
+#include "constants.hpp"
 #include "types.hpp"
 
 namespace hft {
 
-struct BufferPool {
-  static constexpr size_t MAX_MESSAGE_SIZE = 256;
+/**
+ * @brief Size class block pool for buffers and containers of the hot path
+ * Arena is one reserved virtual range cut into spans, every span belongs to one size class
+ * and one owner thread. Threads allocate from their own cache without atomics, refill it in
+ * batches from blocks freed by other threads, then from the global free list, then by
+ * carving a new span. Blocks freed on a foreign thread are pushed back to the owner.
+ * Only threads that allocate take one of the owner ids, ids of exited threads are reused.
+ * Requests above the largest class fall back to the heap
+ */
+class BufferPool {
+  static constexpr size_t MIN_SHIFT = 6;  // 64B
+  static constexpr size_t MAX_SHIFT = 16; // 64KB
+  static constexpr size_t SPAN_SHIFT = 18;
+  static constexpr size_t SPAN_SIZE = 1ULL << SPAN_SHIFT;
+  static constexpr size_t BATCH_SIZE = 32;
+  static constexpr size_t MAX_THREADS = 64;
+  static constexpr uint8_t NO_OWNER = 0xff;
+  static constexpr size_t HUGE_PAGE_SIZE = 2ULL << 20;
+
+public:
+  static constexpr size_t CLASS_COUNT = MAX_SHIFT - MIN_SHIFT + 1;
+  static constexpr size_t MAX_BLOCK_SIZE = 1ULL << MAX_SHIFT;
+
+  struct ClassStats {
+    size_t blockSize;
+    size_t capacity;
+    size_t inUse;
+    size_t highWater;
+  };
+
+  /**
+   * @brief Takes effect only if called before the first use of the pool
+   */
+  static void configure(size_t arenaSize, bool hugePages) {
+    sArenaSize = arenaSize;
+    sHugePages = hugePages;
+  }
+
+  static BufferPool &instance() {
+    static BufferPool pool{sArenaSize, sHugePages};
+    return pool;
+  }
+
+  inline uint8_t *acquire(size_t size) {
+    if (size > MAX_BLOCK_SIZE) [[unlikely]] {
+      const size_t rounded = (size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+      auto *block = static_cast<uint8_t *>(std::aligned_alloc(CACHE_LINE_SIZE, rounded));
+      if (block == nullptr) {
+        throw std::bad_alloc();
+      }
+      return block;
+    }
+    const size_t sizeClass = classOf(size);
+    ThreadCache &cache = threadCache();
+    FreeList &list = cache.lists[sizeClass];
+    if (list.head == nullptr) [[unlikely]] {
+      refill(cache, sizeClass);
+    }
+    Block *block = list.head;
+    list.head = block->next;
+    --list.size;
+    track(cache, sizeClass, 1);
+    return reinterpret_cast<uint8_t *>(block);
+  }
+
+  inline void release(void *ptr) {
+    if (ptr == nullptr) {
+      return;
+    }
+    auto *bytes = static_cast<uint8_t *>(ptr);
+    if (bytes < mBase || bytes >= mBase + mArenaSize) [[unlikely]] {
+      std::free(ptr);
+      return;
+    }
+    const SpanInfo span = mSpans[(bytes - mBase) >> SPAN_SHIFT];
+    auto *block = static_cast<Block *>(ptr);
+    // Thread that never allocated has no id, its frees always go to the owner
+    ThreadCache &cache = localCache();
+    track(cache, span.sizeClass, -1);
+    if (span.owner == cache.id) [[likely]] {
+      FreeList &list = cache.lists[span.sizeClass];
+      block->next = list.head;
+      list.head = block;
+      if (++list.size > 2 * BATCH_SIZE) [[unlikely]] {
+        spill(list, span.sizeClass, BATCH_SIZE);
+      }
+    } else {
+      auto &remote = mRemote[span.owner][span.sizeClass];
+      block->next = remote.load(std::memory_order_relaxed);
+      while (!remote.compare_exchange_weak(block->next, block, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+      }
+    }
+  }
+
+  /**
+   * @brief In use counters are flushed by threads in batches, so they are accurate
+   * up to BATCH_SIZE blocks per thread
+   */
+  std::vector<ClassStats> stats() const {
+    std::vector<ClassStats> result;
+    result.reserve(CLASS_COUNT);
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+      const auto &counters = mCounters[i];
+      const int64_t inUse = counters.inUse.load(std::memory_order_relaxed);
+      result.push_back(ClassStats{1ULL << (i + MIN_SHIFT),
+                                  counters.capacity.load(std::memory_order_relaxed),
+                                  static_cast<size_t>(std::max<int64_t>(inUse, 0)),
+                                  counters.highWater.load(std::memory_order_relaxed)});
+    }
+    return result;
+  }
 
-  BufferPool(size_t size) : mBuffers(size / MAX_MESSAGE_SIZE + 1) {
-    mMemPool = std::aligned_alloc(CACHE_LINE_SIZE, size);
-    if (!mMemPool) {
+  bool hugeTlb() const { return mHugeTlb; }
+
+private:
+  struct Block {
+    Block *next;
+  };
+
+  struct FreeList {
+    Block *head{nullptr};
+    size_t size{0};
+  };
+
+  struct SpanInfo {
+    uint8_t sizeClass;
+    uint8_t owner;
+  };
+
+  struct ThreadCache {
+    uint8_t id{NO_OWNER};
+    std::array<FreeList, CLASS_COUNT> lists{};
+    std::array<int64_t, CLASS_COUNT> inUseDelta{};
+
+    ~ThreadCache() {
+      if (id != NO_OWNER) {
+        BufferPool::instance().retire(*this);
+      } else {
+        BufferPool::instance().flushCounters(*this);
+      }
+    }
+  };
+
+  struct alignas(CACHE_LINE_SIZE) RemoteLists
+      : public std::array<std::atomic<Block *>, CLASS_COUNT> {};
+
+  struct alignas(CACHE_LINE_SIZE) ClassCounters {
+    std::atomic_size_t capacity{0};
+    std::atomic<int64_t> inUse{0};
+    std::atomic_size_t highWater{0};
+    std::mutex globalMtx;
+    FreeList global;
+  };
+
+  BufferPool(size_t arenaSize, bool hugePages)
+      : mArenaSize{(std::max(arenaSize, SPAN_SIZE) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1)},
+        mSpans(mArenaSize >> SPAN_SHIFT) {
+    void *arena = MAP_FAILED;
+    if (hugePages) {
+      // Explicit huge pages are committed upfront, fall back to THP if none are reserved
+      arena = mmap(nullptr, mArenaSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      mHugeTlb = arena != MAP_FAILED;
+    }
+    if (arena == MAP_FAILED) {
+      arena = mmap(nullptr, mArenaSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (arena == MAP_FAILED) {
+        throw std::runtime_error(std::format("Failed to reserve {}B buffer pool", mArenaSize));
+      }
+      if (hugePages) {
+        madvise(arena, mArenaSize, MADV_HUGEPAGE);
+      }
+    }
+    mBase = static_cast<uint8_t *>(arena);
+  }
+
+  ~BufferPool() { munmap(mBase, mArenaSize); }
+
+  static inline size_t classOf(size_t size) {
+    return size <= (1ULL << MIN_SHIFT) ? 0 : std::bit_width(size - 1) - MIN_SHIFT;
+  }
+
+  static inline ThreadCache &localCache() {
+    thread_local ThreadCache cache;
+    return cache;
+  }
+
+  ThreadCache &threadCache() {
+    ThreadCache &cache = localCache();
+    if (cache.id == NO_OWNER) [[unlikely]] {
+      cache.id = acquireId();
+    }
+    return cache;
+  }
+
+  /**
+   * @brief Retired id takes over the spans of the exited thread and the blocks freed to it
+   */
+  uint8_t acquireId() {
+    std::lock_guard lock{mIdsMtx};
+    if (!mFreeIds.empty()) {
+      const uint8_t id = mFreeIds.back();
+      mFreeIds.pop_back();
+      mRetired[id].store(false, std::memory_order_relaxed);
+      return id;
+    }
+    const size_t id = mThreadCount.load(std::memory_order_relaxed);
+    if (id >= MAX_THREADS) {
+      throw std::runtime_error("Buffer pool thread limit reached");
+    }
+    mThreadCount.store(id + 1, std::memory_order_relaxed);
+    return static_cast<uint8_t>(id);
+  }
+
+  void refill(ThreadCache &cache, size_t sizeClass) {
+    FreeList &list = cache.lists[sizeClass];
+    // Blocks returned by other threads first, they are already warm
+    if (takeRemote(list, cache.id, sizeClass)) {
+      return;
+    }
+    {
+      ClassCounters &counters = mCounters[sizeClass];
+      std::lock_guard lock{counters.globalMtx};
+      while (counters.global.head != nullptr && list.size < BATCH_SIZE) {
+        Block *block = counters.global.head;
+        counters.global.head = block->next;
+        --counters.global.size;
+        block->next = list.head;
+        list.head = block;
+        ++list.size;
+      }
+    }
+    if (list.head != nullptr) {
+      return;
+    }
+    // Blocks freed to threads that have exited are reclaimed before the arena grows
+    const size_t threads = mThreadCount.load(std::memory_order_relaxed);
+    for (size_t id = 0; id < threads; ++id) {
+      if (mRetired[id].load(std::memory_order_acquire) && takeRemote(list, id, sizeClass)) {
+        return;
+      }
+    }
+    carve(cache, sizeClass);
+  }
+
+  bool takeRemote(FreeList &list, size_t owner, size_t sizeClass) {
+    Block *block = mRemote[owner][sizeClass].exchange(nullptr, std::memory_order_acquire);
+    if (block == nullptr) {
+      return false;
+    }
+    while (block != nullptr) {
+      Block *next = block->next;
+      block->next = list.head;
+      list.head = block;
+      ++list.size;
+      block = next;
+    }
+    return true;
+  }
+
+  void carve(ThreadCache &cache, size_t sizeClass) {
+    const size_t span = mNextSpan.fetch_add(1, std::memory_order_relaxed);
+    if (span >= mSpans.size()) {
       throw std::bad_alloc();
     }
-    uint8_t *cursor = static_cast<uint8_t *>(mMemPool);
-    for (int i = 0; i < size / MAX_MESSAGE_SIZE; ++i) {
-      mBuffers.push(cursor);
-      cursor += MAX_MESSAGE_SIZE;
+    mSpans[span] = SpanInfo{static_cast<uint8_t>(sizeClass), cache.id};
+    const size_t blockSize = 1ULL << (sizeClass + MIN_SHIFT);
+    uint8_t *begin = mBase + (span << SPAN_SHIFT);
+    FreeList &list = cache.lists[sizeClass];
+    const size_t count = SPAN_SIZE / blockSize;
+    // Pushed backwards so blocks are handed out in address order
+    for (size_t i = count; i-- > 0;) {
+      auto *block = reinterpret_cast<Block *>(begin + i * blockSize);
+      block->next = list.head;
+      list.head = block;
+      ++list.size;
+    }
+    mCounters[sizeClass].capacity.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  void spill(FreeList &list, size_t sizeClass, size_t count) {
+    ClassCounters &counters = mCounters[sizeClass];
+    std::lock_guard lock{counters.globalMtx};
+    for (size_t i = 0; i < count && list.head != nullptr; ++i) {
+      Block *block = list.head;
+      list.head = block->next;
+      --list.size;
+      block->next = counters.global.head;
+      counters.global.head = block;
+      ++counters.global.size;
+    }
+  }
+
+  inline void track(ThreadCache &cache, size_t sizeClass, int64_t delta) {
+    int64_t &pending = cache.inUseDelta[sizeClass];
+    pending += delta;
+    if (pending >= static_cast<int64_t>(BATCH_SIZE) ||
+        pending <= -static_cast<int64_t>(BATCH_SIZE)) [[unlikely]] {
+      flushCounters(cache, sizeClass);
+    }
+  }
+
+  void flushCounters(ThreadCache &cache) {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+      if (cache.inUseDelta[i] != 0) {
+        flushCounters(cache, i);
+      }
     }
   }
-  ~BufferPool() { std::free(mMemPool); }
 
-  uint8_t *acquire() {
-    uint8_t *buffer;
-    while (!mBuffers.pop(buffer)) {
-      spdlog::error("Buffer use limit reached");
-      std::this_thread::yield();
+  void flushCounters(ThreadCache &cache, size_t sizeClass) {
+    ClassCounters &counters = mCounters[sizeClass];
+    const int64_t inUse =
+        counters.inUse.fetch_add(cache.inUseDelta[sizeClass], std::memory_order_relaxed) +
+        cache.inUseDelta[sizeClass];
+    cache.inUseDelta[sizeClass] = 0;
+    size_t highWater = counters.highWater.load(std::memory_order_relaxed);
+    while (inUse > static_cast<int64_t>(highWater) &&
+           !counters.highWater.compare_exchange_weak(highWater, static_cast<size_t>(inUse),
+                                                     std::memory_order_relaxed)) {
     }
-    return buffer;
   }
 
-  void release(uint8_t *buffer) {
-    while (!mBuffers.push(buffer)) {
-      spdlog::error("Buffers capacity miscalculation");
-      std::this_thread::yield();
+  void retire(ThreadCache &cache) {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+      flushCounters(cache, i);
+      takeRemote(cache.lists[i], cache.id, i);
+      spill(cache.lists[i], i, cache.lists[i].size);
     }
+    std::lock_guard lock{mIdsMtx};
+    mRetired[cache.id].store(true, std::memory_order_release);
+    mFreeIds.push_back(cache.id);
   }
 
 private:
-  boost::lockfree::queue<uint8_t *> mBuffers;
-  void *mMemPool;
+  static inline size_t sArenaSize{1ULL << 30};
+  static inline bool sHugePages{false};
+
+  const size_t mArenaSize;
+  uint8_t *mBase{nullptr};
+  bool mHugeTlb{false};
+
+  std::vector<SpanInfo> mSpans;
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mNextSpan{0};
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mThreadCount{0};
+  std::mutex mIdsMtx;
+  std::vector<uint8_t> mFreeIds;
+
+  std::array<RemoteLists, MAX_THREADS> mRemote;
+  std::array<std::atomic_bool, MAX_THREADS> mRetired{};
+  std::array<ClassCounters, CLASS_COUNT> mCounters;
+};
+
+/**
+ * @brief Owning handle of a pool block, safe to move into a completion handler
+ */
+struct PoolDeleter {
+  void operator()(uint8_t *buffer) const { BufferPool::instance().release(buffer); }
 };
+using PoolBuffer = std::unique_ptr<uint8_t[], PoolDeleter>;
+
+inline PoolBuffer makePoolBuffer(size_t size) {
+  return PoolBuffer{BufferPool::instance().acquire(size)};
+}
+
+/**
+ * @brief Lets standard containers draw from the pool
+ */
+template <typename Type>
+struct PoolAllocator {
+  static_assert(alignof(Type) <= CACHE_LINE_SIZE);
+  using value_type = Type;
+
+  PoolAllocator() = default;
+  template <typename Other>
+  PoolAllocator(const PoolAllocator<Other> &) {}
 
-struct BufferGuard {
-  BufferGuard(uint8_t *bufferPtr, BufferPool &bPool) : buffer{bufferPtr}, pool{bPool} {}
-  ~BufferGuard() { pool.release(buffer); }
+  Type *allocate(size_t count) {
+    return reinterpret_cast<Type *>(BufferPool::instance().acquire(count * sizeof(Type)));
+  }
+  void deallocate(Type *ptr, size_t) { BufferPool::instance().release(ptr); }
 
-  uint8_t *buffer;
-  BufferPool &pool;
+  template <typename Other>
+  bool operator==(const PoolAllocator<Other> &) const {
+    return true;
+  }
 };
 
+template <typename Type>
+using PoolVector = std::vector<Type, PoolAllocator<Type>>;
+
 } // namespace hft
 
 #endif // HFT_COMMON_BUFFERPOOL_HPP
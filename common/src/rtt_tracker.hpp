@@ -6,11 +6,13 @@
 #ifndef HFT_COMMON_RTTTRACKER_HPP
 #define HFT_COMMON_RTTTRACKER_HPP
 
+#include <array>
 #include <atomic>
-#include <memory>
-#include <set>
-#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
 
+#include "logger.hpp"
 #include "template_types.hpp"
 #include "types.hpp"
 #include "utils/utils.hpp"
@@ -18,78 +20,73 @@
 namespace hft {
 
 /**
- * @brief HdrHistogram at home
+ * @brief HdrHistogram at home. Samples and ranges are in Unit, first range is treated as
+ * the budget. Tag gives each tracker its own stats and a name for printing.
+ * Threads flush their samples at most FlushIntervalNs apart while logging, and once more
+ * when they exit
  */
-template <size_t... Ranges>
+template <typename Tag, typename Unit, size_t... Ranges>
 class RttTracker {
-  static_assert(sizeof...(Ranges) == 0 || is_ascending<Ranges...>(), "Ranges should be ascending");
+  static_assert(sizeof...(Ranges) > 0 && is_ascending<Ranges..., SIZE_MAX>(),
+                "Ranges should be ascending");
 
   static constexpr std::array<size_t, sizeof...(Ranges)> rangeValues = {Ranges...};
   static constexpr size_t RangeCount = sizeof...(Ranges) + 1;
-  static constexpr size_t FlushTimeoutMs = 1000;
+  static constexpr uint64_t NsPerUnit = std::chrono::nanoseconds{Unit{1}}.count();
+  static constexpr uint64_t FlushIntervalNs = 100'000'000;
 
-  struct alignas(64) AtomicRttSample {
+  struct alignas(64) AtomicSample {
     std::atomic_uint64_t sum{0};
-    Padding<size_t> p;
     std::atomic_uint64_t size{0};
   };
-  struct AtomicRttStats {
-    std::array<AtomicRttSample, RangeCount> samples{};
-  };
-
-public:
-  struct RttSample {
+  struct Sample {
     uint64_t sum{0};
     uint64_t size{0};
   };
-  struct RttStats {
-    std::array<RttSample, RangeCount> samples{};
+  struct LocalStats {
+    std::array<Sample, RangeCount> samples{};
+    uint64_t lastFlushed{0};
+
+    ~LocalStats() { flush(*this); }
   };
 
+public:
+  static inline uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /**
+   * @brief Round trip of a message stamped with getLinuxTimestamp, returned in Unit
+   */
   static TimestampRaw logRtt(TimestampRaw timestamp) {
-    thread_local AtomicRttStats stats;
-    thread_local TimestampRaw lastFlushed = utils::getLinuxTimestamp();
-    TimestampRaw current = utils::getLinuxTimestamp();
-    auto rtt = (current - timestamp) / 1000;
-
-    uint8_t scale = getRange(rtt);
-    stats.samples[scale].sum += rtt;
-    stats.samples[scale].size++;
-    if (current - lastFlushed > FlushTimeoutMs) {
-      for (int i = 0; i < RangeCount; ++i) {
-        sGlobalStats.samples[i].sum.fetch_add(stats.samples[i].sum, std::memory_order_relaxed);
-        sGlobalStats.samples[i].size.fetch_add(stats.samples[i].size, std::memory_order_relaxed);
-        stats.samples[i].sum = 0;
-        stats.samples[i].size = 0;
-      }
-      lastFlushed = current;
-    }
-    return rtt;
+    const TimestampRaw elapsed = utils::getLinuxTimestamp() - timestamp;
+    return static_cast<TimestampRaw>(record(elapsed, now()));
   }
 
-  static RttStats getStats() {
-    RttStats stats;
-    for (int i = 0; i < RangeCount; ++i) {
-      stats.samples[i].sum = sGlobalStats.samples[i].sum.load(std::memory_order_relaxed);
-      stats.samples[i].size = sGlobalStats.samples[i].size.load(std::memory_order_relaxed);
-    }
-    return stats;
+  static inline void log(uint64_t latencyNs) { record(latencyNs, now()); }
+
+  static inline void logSince(uint64_t startNs) {
+    const uint64_t current = now();
+    record(current - startNs, current);
   }
 
   static void printStats() {
-    auto rttStats = getStats();
-    auto &rtt = rttStats.samples;
-    auto sizeTotal = 0;
-    for (int i = 0; i < RangeCount; ++i) {
-      sizeTotal += rtt[i].size;
+    std::array<Sample, RangeCount> stats{};
+    uint64_t sizeTotal = 0;
+    for (size_t i = 0; i < RangeCount; ++i) {
+      stats[i].sum = sGlobal[i].sum.load(std::memory_order_relaxed);
+      stats[i].size = sGlobal[i].size.load(std::memory_order_relaxed);
+      sizeTotal += stats[i].size;
     }
     if (sizeTotal == 0) {
       return;
     }
     std::stringstream ss;
     ss << std::fixed << std::setprecision(2);
-    ss << "RTT [";
-    for (int i = 0; i < RangeCount; ++i) {
+    ss << Tag::NAME << " [";
+    for (size_t i = 0; i < RangeCount; ++i) {
       if (i < RangeCount - 1) {
         ss << "<" << toScale(rangeValues[i]) << "|";
       } else {
@@ -97,42 +94,77 @@ public:
       }
     }
     ss << "  ";
-    for (int i = 0; i < RangeCount; ++i) {
-      auto avg = ((rtt[i].size != 0) ? (rtt[i].sum / rtt[i].size) : 0);
-      if (avg == 0) {
+    for (size_t i = 0; i < RangeCount; ++i) {
+      if (stats[i].size == 0) {
         ss << "-  ";
       } else {
-        ss << ((float)rtt[i].size / sizeTotal) * 100 << "% avg:";
-        ss << toScale(avg);
-        ss << "  ";
+        ss << ((float)stats[i].size / sizeTotal) * 100 << "% avg:";
+        ss << toScale(stats[i].sum / stats[i].size) << "  ";
       }
     }
     Logger::monitorLogger->info(ss.str());
   }
 
 private:
-  static constexpr inline uint8_t getRange(TimestampRaw value) {
-    for (int i = 0; i < RangeCount; ++i) {
+  static inline uint64_t record(uint64_t latencyNs, uint64_t nowNs) {
+    thread_local LocalStats stats;
+    const uint64_t value = latencyNs / NsPerUnit;
+    auto &sample = stats.samples[getRange(value)];
+    sample.sum += value;
+    sample.size++;
+    if (nowNs - stats.lastFlushed > FlushIntervalNs) [[unlikely]] {
+      flush(stats);
+      stats.lastFlushed = nowNs;
+    }
+    return value;
+  }
+
+  static void flush(LocalStats &stats) {
+    for (size_t i = 0; i < RangeCount; ++i) {
+      sGlobal[i].sum.fetch_add(stats.samples[i].sum, std::memory_order_relaxed);
+      sGlobal[i].size.fetch_add(stats.samples[i].size, std::memory_order_relaxed);
+      stats.samples[i] = Sample{};
+    }
+  }
+
+  static constexpr inline size_t getRange(uint64_t value) {
+    for (size_t i = 0; i < RangeCount - 1; ++i) {
       if (value < rangeValues[i]) {
         return i;
       }
     }
-    return RangeCount;
+    return RangeCount - 1;
   }
-  static inline std::string toScale(TimestampRaw value) {
-    bool us = value < 1000;
-    if (!us) {
-      value /= 1000;
+
+  static inline std::string toScale(uint64_t value) {
+    value *= NsPerUnit;
+    if (value < 1000) {
+      return std::to_string(value) + "ns";
     }
-    return std::to_string(value) + (us ? "us" : "ms");
+    if (value < 1000000) {
+      return std::to_string(value / 1000) + "us";
+    }
+    return std::to_string(value / 1000000) + "ms";
   }
 
-  static AtomicRttStats sGlobalStats;
+  static std::array<AtomicSample, RangeCount> sGlobal;
+};
+
+template <typename Tag, typename Unit, size_t... Ranges>
+std::array<typename RttTracker<Tag, Unit, Ranges...>::AtomicSample,
+           RttTracker<Tag, Unit, Ranges...>::RangeCount>
+    RttTracker<Tag, Unit, Ranges...>::sGlobal;
+
+struct RoundTrip {
+  static constexpr auto NAME = "RTT";
 };
 
-template <size_t... Ranges>
-RttTracker<Ranges...>::AtomicRttStats RttTracker<Ranges...>::sGlobalStats;
+/**
+ * @brief Per hop latency in nanoseconds, for stages that take well below a microsecond
+ */
+template <typename Tag, size_t... Ranges>
+using LatencyTracker = RttTracker<Tag, std::chrono::nanoseconds, Ranges...>;
 
 } // namespace hft
 
-#endif // HFT_COMMON_RTTTRACKER_HPP
\ No newline at end of file
+#endif // HFT_COMMON_RTTTRACKER_HPP
@@ -45,6 +45,70 @@ gen::fbs::OrderAction convert(OrderAction action) {
   }
 }
 
+OrderType convert(gen::fbs::OrderType type) {
+  switch (type) {
+  case gen::fbs::OrderType::OrderType_LIMIT:
+    return OrderType::Limit;
+  case gen::fbs::OrderType::OrderType_MARKET:
+    return OrderType::Market;
+  case gen::fbs::OrderType::OrderType_POST_ONLY:
+    return OrderType::PostOnly;
+  case gen::fbs::OrderType::OrderType_STOP:
+    return OrderType::Stop;
+  case gen::fbs::OrderType::OrderType_STOP_LIMIT:
+    return OrderType::StopLimit;
+  default:
+    spdlog::error("Unknown OrderType {}", (uint8_t)type);
+    return OrderType::Limit;
+  }
+}
+
+gen::fbs::OrderType convert(OrderType type) {
+  switch (type) {
+  case OrderType::Limit:
+    return gen::fbs::OrderType::OrderType_LIMIT;
+  case OrderType::Market:
+    return gen::fbs::OrderType::OrderType_MARKET;
+  case OrderType::PostOnly:
+    return gen::fbs::OrderType::OrderType_POST_ONLY;
+  case OrderType::Stop:
+    return gen::fbs::OrderType::OrderType_STOP;
+  case OrderType::StopLimit:
+    return gen::fbs::OrderType::OrderType_STOP_LIMIT;
+  default:
+    spdlog::error("Unknown OrderType {}", (uint8_t)type);
+    return gen::fbs::OrderType::OrderType_LIMIT;
+  }
+}
+
+TimeInForce convert(gen::fbs::TimeInForce tif) {
+  switch (tif) {
+  case gen::fbs::TimeInForce::TimeInForce_GTC:
+    return TimeInForce::Gtc;
+  case gen::fbs::TimeInForce::TimeInForce_IOC:
+    return TimeInForce::Ioc;
+  case gen::fbs::TimeInForce::TimeInForce_FOK:
+    return TimeInForce::Fok;
+  default:
+    spdlog::error("Unknown TimeInForce {}", (uint8_t)tif);
+    return TimeInForce::Gtc;
+  }
+}
+
+gen::fbs::TimeInForce convert(TimeInForce tif) {
+  switch (tif) {
+  case TimeInForce::Gtc:
+    return gen::fbs::TimeInForce::TimeInForce_GTC;
+  case TimeInForce::Ioc:
+    return gen::fbs::TimeInForce::TimeInForce_IOC;
+  case TimeInForce::Fok:
+    return gen::fbs::TimeInForce::TimeInForce_FOK;
+  default:
+    spdlog::error("Unknown TimeInForce {}", (uint8_t)tif);
+    return gen::fbs::TimeInForce::TimeInForce_GTC;
+  }
+}
+
 OrderState convert(gen::fbs::OrderState state) { return static_cast<OrderState>(state); }
 
 gen::fbs::OrderState convert(OrderState state) { return static_cast<gen::fbs::OrderState>(state); }
@@ -34,7 +34,11 @@ public:
                  fbStringToTicker(msg->ticker()),
                  msg->quantity(),
                  msg->price(),
-                 convert(msg->action())};
+                 convert(msg->action()),
+                 convert(msg->type()),
+                 convert(msg->tif()),
+                 msg->display_quantity(),
+                 msg->trigger_price()};
   }
 
   template <typename MessageType>
@@ -63,15 +67,42 @@ public:
       spdlog::error("TickerPrice verification failed");
       return StatusCode::Error;
     }
-    auto orderMsg = flatbuffers::GetRoot<gen::fbs::TickerPrice>(buffer);
-    return TickerPrice{fbStringToTicker(orderMsg->ticker()), orderMsg->price()};
+    auto msg = flatbuffers::GetRoot<gen::fbs::TickerPrice>(buffer);
+    return TickerPrice{fbStringToTicker(msg->ticker()), msg->price(), msg->bid(), msg->ask(),
+                       msg->bid_quantity(), msg->ask_quantity()};
+  }
+
+  template <typename MessageType>
+  static std::enable_if_t<std::is_same<MessageType, LoginRequest>::value, Result<LoginRequest>>
+  deserialize(const uint8_t *buffer, size_t size) {
+    flatbuffers::Verifier verifier(buffer, size);
+    if (!verifier.VerifyBuffer<gen::fbs::LoginRequest>()) {
+      spdlog::error("LoginRequest verification failed");
+      return StatusCode::Error;
+    }
+    auto msg = flatbuffers::GetRoot<gen::fbs::LoginRequest>(buffer);
+    return LoginRequest{msg->trader_id(), msg->token()};
+  }
+
+  template <typename MessageType>
+  static std::enable_if_t<std::is_same<MessageType, LoginResponse>::value, Result<LoginResponse>>
+  deserialize(const uint8_t *buffer, size_t size) {
+    flatbuffers::Verifier verifier(buffer, size);
+    if (!verifier.VerifyBuffer<gen::fbs::LoginResponse>()) {
+      spdlog::error("LoginResponse verification failed");
+      return StatusCode::Error;
+    }
+    auto msg = flatbuffers::GetRoot<gen::fbs::LoginResponse>(buffer);
+    return LoginResponse{msg->trader_id(), msg->token()};
   }
 
   static DetachedBuffer serialize(const Order &order) {
     flatbuffers::FlatBufferBuilder builder;
     auto msg = gen::fbs::CreateOrder(builder, order.id,
                                      builder.CreateString(order.ticker.data(), TICKER_SIZE),
-                                     order.quantity, order.price, convert(order.action));
+                                     order.quantity, order.price, convert(order.action),
+                                     convert(order.type), convert(order.tif), order.display,
+                                     order.trigger);
     builder.Finish(msg);
     return builder.Release();
   }
@@ -88,7 +119,22 @@ public:
   static DetachedBuffer serialize(const TickerPrice &price) {
     flatbuffers::FlatBufferBuilder builder;
     auto msg = gen::fbs::CreateTickerPrice(
-        builder, builder.CreateString(price.ticker.data(), TICKER_SIZE), price.price);
+        builder, builder.CreateString(price.ticker.data(), TICKER_SIZE), price.price, price.bid,
+        price.ask, price.bidQuantity, price.askQuantity);
+    builder.Finish(msg);
+    return builder.Release();
+  }
+
+  static DetachedBuffer serialize(const LoginRequest &request) {
+    flatbuffers::FlatBufferBuilder builder;
+    auto msg = gen::fbs::CreateLoginRequest(builder, request.traderId, request.token);
+    builder.Finish(msg);
+    return builder.Release();
+  }
+
+  static DetachedBuffer serialize(const LoginResponse &response) {
+    flatbuffers::FlatBufferBuilder builder;
+    auto msg = gen::fbs::CreateLoginResponse(builder, response.traderId, response.token);
     builder.Finish(msg);
     return builder.Release();
   }
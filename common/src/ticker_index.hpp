@@ -0,0 +1,139 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-04
+ */
+
+#ifndef HFT_COMMON_TICKERINDEX_HPP
+#define HFT_COMMON_TICKERINDEX_HPP
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "market_types.hpp"
+#include "types.hpp"
+
+namespace hft {
+
+/**
+ * @brief Perfect hash from packed ticker to dense TickerId, built once at startup
+ * Hash and displace: key picks a bucket, bucket displacement picks a collision free slot
+ * Lookup is two dependent loads from small arrays and one compare to reject unknown tickers
+ */
+class TickerIndex {
+  static constexpr uint32_t BUCKET_SEED = 0x5bd1e995;
+  static constexpr uint32_t MAX_DISPLACEMENT = 1 << 16;
+
+  struct Slot {
+    uint32_t key{0};
+    TickerId id{INVALID_TICKER_ID};
+  };
+
+public:
+  TickerIndex() = default;
+  explicit TickerIndex(const std::vector<TickerPrice> &tickers) { build(tickers); }
+
+  /**
+   * @brief Dense ids follow the order of the input, duplicates keep the first id
+   */
+  void build(const std::vector<TickerPrice> &tickers) {
+    std::vector<uint32_t> keys;
+    std::unordered_set<uint32_t> unique;
+    keys.reserve(tickers.size());
+    for (auto &item : tickers) {
+      auto key = packTicker(item.ticker);
+      if (key != 0 && unique.insert(key).second) {
+        keys.push_back(key);
+      }
+    }
+    if (keys.size() >= INVALID_TICKER_ID) {
+      throw std::runtime_error("Too many tickers for TickerIndex");
+    }
+    mTickers.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      std::memcpy(mTickers[i].data(), &keys[i], sizeof(uint32_t));
+    }
+    size_t tableSize = std::bit_ceil(std::max<size_t>(keys.size() * 2, 2));
+    while (!tryBuild(keys, tableSize)) {
+      tableSize *= 2;
+    }
+  }
+
+  inline TickerId find(uint32_t key) const {
+    uint32_t displacement = mDisplacements[mix(key, BUCKET_SEED) & mBucketMask];
+    const Slot &slot = mSlots[mix(key, displacement) & mSlotMask];
+    return slot.key == key ? slot.id : INVALID_TICKER_ID;
+  }
+  inline TickerId find(TickerRef ticker) const { return find(packTicker(ticker)); }
+
+  inline TickerRef ticker(TickerId id) const { return mTickers[id]; }
+  inline size_t size() const { return mTickers.size(); }
+
+private:
+  static inline uint32_t mix(uint32_t key, uint32_t seed) {
+    uint32_t hash = (key ^ seed) * 0x9e3779b1;
+    return hash ^ (hash >> 15);
+  }
+
+  bool tryBuild(const std::vector<uint32_t> &keys, size_t tableSize) {
+    const size_t bucketCount = std::bit_ceil(std::max<size_t>(keys.size() / 4, 1));
+    mBucketMask = bucketCount - 1;
+    mSlotMask = tableSize - 1;
+    mDisplacements.assign(bucketCount, 0);
+    mSlots.assign(tableSize, Slot{});
+
+    std::vector<std::vector<TickerId>> buckets(bucketCount);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      buckets[mix(keys[i], BUCKET_SEED) & mBucketMask].push_back(i);
+    }
+    std::vector<size_t> order(bucketCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&buckets](size_t l, size_t r) { return buckets[l].size() > buckets[r].size(); });
+
+    std::vector<uint32_t> taken;
+    for (size_t bucketIdx : order) {
+      const auto &bucket = buckets[bucketIdx];
+      if (bucket.empty()) {
+        break;
+      }
+      bool placed = false;
+      for (uint32_t displacement = 1; displacement < MAX_DISPLACEMENT && !placed; ++displacement) {
+        taken.clear();
+        placed = true;
+        for (TickerId id : bucket) {
+          uint32_t slot = mix(keys[id], displacement) & mSlotMask;
+          if (mSlots[slot].key != 0 || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+            placed = false;
+            break;
+          }
+          taken.push_back(slot);
+        }
+        if (placed) {
+          mDisplacements[bucketIdx] = displacement;
+          for (size_t i = 0; i < bucket.size(); ++i) {
+            mSlots[taken[i]] = Slot{keys[bucket[i]], bucket[i]};
+          }
+        }
+      }
+      if (!placed) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  std::vector<uint32_t> mDisplacements{0};
+  std::vector<Slot> mSlots{Slot{}};
+  std::vector<Ticker> mTickers;
+  uint32_t mBucketMask{0};
+  uint32_t mSlotMask{0};
+};
+
+} // namespace hft
+
+#endif // HFT_COMMON_TICKERINDEX_HPP
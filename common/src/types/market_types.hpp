@@ -7,7 +7,9 @@
 #define HFT_COMMON_MARKET_TYPES_HPP
 
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <limits>
 #include <string_view>
 
 #include "types.hpp"
@@ -23,6 +25,19 @@ constexpr size_t TICKER_SIZE = 4;
 using Ticker = std::array<char, TICKER_SIZE>;
 using TickerRef = const Ticker &;
 
+/**
+ * @brief Dense index of a ticker in the loaded universe, see TickerIndex
+ */
+using TickerId = uint16_t;
+constexpr TickerId INVALID_TICKER_ID = std::numeric_limits<TickerId>::max();
+
+static_assert(TICKER_SIZE == sizeof(uint32_t), "Ticker is expected to pack into uint32_t");
+inline uint32_t packTicker(TickerRef ticker) {
+  uint32_t packed;
+  std::memcpy(&packed, ticker.data(), sizeof(packed));
+  return packed;
+}
+
 struct TickerHash {
   std::size_t operator()(const Ticker &t) const {
     return std::hash<std::string_view>{}(std::string_view(t.data(), t.size()));
@@ -34,9 +49,31 @@ enum class OrderState : uint8_t {
   Accepted = 0U,
   Partial = 1U << 0,
   Full = 1U << 1,
-  Instant = 1U << 2
+  Instant = 1U << 2,
+  Rejected = 1U << 3,
+  Cancelled = 1U << 4,
+  Resting = 1U << 5 // Resting order hit by an incoming one, fill or self trade cancel
+};
+
+/**
+ * @brief Market orders carry no price, it is set to the protection limit on the way in.
+ * Post only orders are rejected instead of taking liquidity. Stop orders are held until
+ * the last trade price reaches the trigger, then go in as a market or a limit order
+ */
+enum class OrderType : uint8_t {
+  Limit = 0U,
+  Market = 1U,
+  PostOnly = 2U,
+  Stop = 3U,
+  StopLimit = 4U
 };
 
+/**
+ * @brief Anything but Gtc never rests, the unfilled remainder is cancelled.
+ * Fok is cancelled upfront unless it can be filled completely
+ */
+enum class TimeInForce : uint8_t { Gtc = 0U, Ioc = 1U, Fok = 2U };
+
 struct Order {
   TraderId traderId; // Server side
   OrderId id;
@@ -44,7 +81,12 @@ struct Order {
   Quantity quantity;
   Price price;
   OrderAction action;
+  OrderType type{OrderType::Limit};
+  TimeInForce tif{TimeInForce::Gtc};
+  Quantity display{0}; // Iceberg peak, zero shows the whole quantity
+  Price trigger{0};    // Stop orders only
 };
+static_assert(sizeof(Order) == 32, "Order is expected to take half a cache line");
 
 struct OrderStatus {
   TraderId traderId; // Server side
@@ -56,9 +98,33 @@ struct OrderStatus {
   OrderAction action;
 };
 
+/**
+ * @brief Last trade price with the best level of each side, zeroes for an empty side.
+ * Quantities are the shown ones, iceberg reserves are not published
+ */
 struct TickerPrice {
   Ticker ticker{};
   Price price;
+  Price bid{0};
+  Price ask{0};
+  Quantity bidQuantity{0};
+  Quantity askQuantity{0};
+};
+
+using SessionToken = uint64_t;
+
+/**
+ * @brief Session handshake. Server assigns a dense session index and a random token on
+ * ingress connect, trader presents both on the egress connection to bind it to the session
+ */
+struct LoginRequest {
+  TraderId traderId;
+  SessionToken token;
+};
+
+struct LoginResponse {
+  TraderId traderId;
+  SessionToken token;
 };
 
 } // namespace hft
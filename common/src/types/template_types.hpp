@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 #include <functional>
 #include <memory>
 #include <span>
@@ -76,6 +77,9 @@ using UPtrLFQueue = std::unique_ptr<LFQueue<EventType>>;
 template <typename EventType>
 using SPtrLFQueue = std::shared_ptr<LFQueue<EventType>>;
 
+template <typename EventType>
+using SPSCQueue = boost::lockfree::spsc_queue<EventType>;
+
 template <typename EventType>
 static UPtrLFQueue<EventType> createLFQueue(std::size_t size) {
   return std::make_unique<LFQueue<EventType>>(size);
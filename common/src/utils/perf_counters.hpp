@@ -0,0 +1,110 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-15
+ */
+
+#ifndef HFT_COMMON_PERFCOUNTERS_HPP
+#define HFT_COMMON_PERFCOUNTERS_HPP
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+
+#include "types.hpp"
+
+namespace hft::utils {
+
+/**
+ * @brief Hardware counters of the calling thread through perf_event_open
+ * Counters the kernel or the cpu refuses are reported as unavailable, so the caller still
+ * gets timings on virtual machines or with a restrictive perf_event_paranoid
+ */
+class PerfCounters {
+public:
+  enum Event : size_t { Cycles, Instructions, L1dReadMisses, LlcReadMisses, Count };
+
+  PerfCounters() {
+    mFds[Cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    mFds[Instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    mFds[L1dReadMisses] = open(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+    mFds[LlcReadMisses] = open(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+  }
+  ~PerfCounters() {
+    for (int fd : mFds) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  void start() {
+    for (int fd : mFds) {
+      if (fd != -1) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void stop() {
+    for (size_t i = 0; i < Count; ++i) {
+      mValues[i] = 0;
+      if (mFds[i] != -1) {
+        ioctl(mFds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(mFds[i], &mValues[i], sizeof(uint64_t)) != sizeof(uint64_t)) {
+          mValues[i] = 0;
+        }
+      }
+    }
+  }
+
+  bool available(Event event) const { return mFds[event] != -1; }
+  uint64_t value(Event event) const { return mValues[event]; }
+
+  static const char *name(Event event) {
+    switch (event) {
+    case Cycles:
+      return "cycles";
+    case Instructions:
+      return "instructions";
+    case L1dReadMisses:
+      return "L1d-read-misses";
+    case LlcReadMisses:
+      return "LLC-read-misses";
+    default:
+      return "";
+    }
+  }
+
+private:
+  static uint64_t cacheMiss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  static int open(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+private:
+  std::array<int, Count> mFds{};
+  std::array<uint64_t, Count> mValues{};
+};
+
+} // namespace hft::utils
+
+#endif // HFT_COMMON_PERFCOUNTERS_HPP
@@ -7,7 +7,7 @@
 
 namespace hft::utils {
 
-std::random_device RNG::kRandomDevice;
-std::mt19937 RNG::kRandomAlgo{kRandomDevice()};
+std::atomic_uint64_t RNG::sSeed{std::random_device{}()};
+std::atomic_uint64_t RNG::sNextStream{1};
 
 } // namespace hft::utils
@@ -6,30 +6,297 @@
 #ifndef HFT_COMMON_RNG_HPP
 #define HFT_COMMON_RNG_HPP
 
+#include <immintrin.h>
+
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <random>
+#include <type_traits>
+
+#include "simd.hpp"
 
 namespace hft::utils {
 
+namespace rng_detail {
+
+inline uint64_t splitMix64(uint64_t &state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+inline uint64_t rotl(uint64_t value, int shift) {
+  return (value << shift) | (value >> (64 - shift));
+}
+
+/**
+ * @brief Four xoshiro256++ generators stepped together, word major so each state word of
+ * all lanes is one AVX2 register. Every step gives 8 uint32 values, low half of each lane
+ * first. Scalar path steps the same lanes, so output does not depend on the SIMD level
+ */
+struct alignas(32) Lanes {
+  uint64_t words[4][4];
+};
+
+inline void stepScalar(Lanes &lanes, uint32_t *out, uint32_t range) {
+  auto &s = lanes.words;
+  for (size_t lane = 0; lane < 4; ++lane) {
+    const uint64_t result = rotl(s[0][lane] + s[3][lane], 23) + s[0][lane];
+    const uint64_t t = s[1][lane] << 17;
+    s[2][lane] ^= s[0][lane];
+    s[3][lane] ^= s[1][lane];
+    s[1][lane] ^= s[2][lane];
+    s[0][lane] ^= s[3][lane];
+    s[2][lane] ^= t;
+    s[3][lane] = rotl(s[3][lane], 45);
+    const auto low = static_cast<uint32_t>(result);
+    const auto high = static_cast<uint32_t>(result >> 32);
+    out[lane * 2] = range == 0 ? low : static_cast<uint32_t>((uint64_t{low} * range) >> 32);
+    out[lane * 2 + 1] = range == 0 ? high : static_cast<uint32_t>((uint64_t{high} * range) >> 32);
+  }
+}
+
+__attribute__((target("avx2"))) inline __m256i rotlAvx2(__m256i value, int shift) {
+  return _mm256_or_si256(_mm256_slli_epi64(value, shift), _mm256_srli_epi64(value, 64 - shift));
+}
+
+/**
+ * @brief Fills count values rounded down to whole steps, returns how many were written
+ */
+__attribute__((target("avx2"))) inline size_t fillAvx2(Lanes &lanes, uint32_t *out,
+                                                       size_t count, uint32_t range) {
+  auto *words = reinterpret_cast<__m256i *>(lanes.words);
+  __m256i s0 = _mm256_load_si256(words);
+  __m256i s1 = _mm256_load_si256(words + 1);
+  __m256i s2 = _mm256_load_si256(words + 2);
+  __m256i s3 = _mm256_load_si256(words + 3);
+  const __m256i multiplier = _mm256_set1_epi64x(range);
+  const __m256i highMask = _mm256_set1_epi64x(static_cast<int64_t>(0xFFFFFFFF00000000ULL));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i result = _mm256_add_epi64(rotlAvx2(_mm256_add_epi64(s0, s3), 23), s0);
+    const __m256i t = _mm256_slli_epi64(s1, 17);
+    s2 = _mm256_xor_si256(s2, s0);
+    s3 = _mm256_xor_si256(s3, s1);
+    s1 = _mm256_xor_si256(s1, s2);
+    s0 = _mm256_xor_si256(s0, s3);
+    s2 = _mm256_xor_si256(s2, t);
+    s3 = rotlAvx2(s3, 45);
+    if (range != 0) {
+      // Multiply shift of both halves, low products land in the low half of each lane
+      const __m256i low = _mm256_srli_epi64(_mm256_mul_epu32(result, multiplier), 32);
+      const __m256i high = _mm256_and_si256(
+          _mm256_mul_epu32(_mm256_srli_epi64(result, 32), multiplier), highMask);
+      result = _mm256_or_si256(low, high);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+  }
+  _mm256_store_si256(words, s0);
+  _mm256_store_si256(words + 1, s1);
+  _mm256_store_si256(words + 2, s2);
+  _mm256_store_si256(words + 3, s3);
+  return i;
+}
+
+} // namespace rng_detail
+
+/**
+ * @brief xoshiro256++, 256 bits of state, four adds, shifts and rotates per 64 bit value
+ */
+class Xoshiro256pp {
+public:
+  explicit Xoshiro256pp(uint64_t seed = 0) { reseed(seed); }
+
+  void reseed(uint64_t seed) {
+    for (auto &word : mState) {
+      word = rng_detail::splitMix64(seed);
+    }
+  }
+
+  inline uint64_t operator()() {
+    auto &s = mState;
+    const uint64_t result = rng_detail::rotl(s[0] + s[3], 23) + s[0];
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_detail::rotl(s[3], 45);
+    return result;
+  }
+
+  /**
+   * @brief Advances by 2^128 values, streams split by jumps never overlap
+   */
+  void jump() {
+    static constexpr std::array<uint64_t, 4> JUMP = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                                     0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+    std::array<uint64_t, 4> state{};
+    for (uint64_t word : JUMP) {
+      for (int bit = 0; bit < 64; ++bit) {
+        if ((word & (1ULL << bit)) != 0) {
+          for (size_t i = 0; i < state.size(); ++i) {
+            state[i] ^= mState[i];
+          }
+        }
+        (*this)();
+      }
+    }
+    mState = state;
+  }
+
+private:
+  std::array<uint64_t, 4> mState;
+};
+
+/**
+ * @brief Thread local generators, no locking and no distribution objects. Every thread
+ * draws from its own stream of the process seed, a thread takes the next free stream
+ * unless it picks one with seedThread, which makes runs with a fixed seed repeatable.
+ * Bounded values use Lemire's multiply shift with rejection, so they are unbiased
+ */
 class RNG {
+  static constexpr size_t LANE_STREAMS = 4;
+
 public:
+  /**
+   * @brief Sets the process seed and reseeds the calling thread with stream 0,
+   * zero takes one from random_device. Returns the seed in use
+   */
+  static uint64_t seed(uint64_t seed) {
+    if (seed == 0) {
+      std::random_device device;
+      seed = (uint64_t{device()} << 32) | device();
+    }
+    sSeed.store(seed, std::memory_order_relaxed);
+    seedThread(0);
+    return seed;
+  }
+
+  /**
+   * @brief Reseeds the calling thread with the given stream of the process seed
+   */
+  static void seedThread(uint64_t stream) { state().reseed(sSeed.load(), stream); }
+
+  /**
+   * @brief Uniform value in [0, number], number is expected to be non negative
+   */
   template <typename Type>
   static typename std::enable_if<std::is_integral<Type>::value, Type>::type rng(Type number) {
-    std::uniform_int_distribution<Type> dis(0, number);
-    return dis(kRandomAlgo);
+    const uint64_t top = static_cast<std::make_unsigned_t<Type>>(number);
+    if (top == UINT64_MAX) {
+      return static_cast<Type>(next());
+    }
+    if (top < UINT32_MAX) {
+      return static_cast<Type>(bounded(static_cast<uint32_t>(top + 1)));
+    }
+    return static_cast<Type>(bounded(top + 1));
   }
 
   template <typename Type>
   static typename std::enable_if<std::is_floating_point<Type>::value, Type>::type rng(Type number) {
-    std::uniform_real_distribution<Type> dis(0.0, number);
-    return dis(kRandomAlgo);
+    return static_cast<Type>((next() >> 11) * 0x1.0p-53 * number);
+  }
+
+  static inline uint64_t next() { return state().generator(); }
+
+  /**
+   * @brief Value in [0, range), range is not zero
+   */
+  static inline uint32_t bounded(uint32_t range) {
+    uint64_t product = uint64_t{next32()} * range;
+    auto low = static_cast<uint32_t>(product);
+    if (low < range) [[unlikely]] {
+      const uint32_t threshold = -range % range;
+      while (low < threshold) {
+        product = uint64_t{next32()} * range;
+        low = static_cast<uint32_t>(product);
+      }
+    }
+    return static_cast<uint32_t>(product >> 32);
+  }
+
+  static inline uint64_t bounded(uint64_t range) {
+    __uint128_t product = static_cast<__uint128_t>(next()) * range;
+    auto low = static_cast<uint64_t>(product);
+    if (low < range) [[unlikely]] {
+      const uint64_t threshold = -range % range;
+      while (low < threshold) {
+        product = static_cast<__uint128_t>(next()) * range;
+        low = static_cast<uint64_t>(product);
+      }
+    }
+    return static_cast<uint64_t>(product >> 64);
+  }
+
+  /**
+   * @brief Multiply shift of a raw value into [0, range) without the rejection step,
+   * bias is below range / 2^32. For values drawn in bulk
+   */
+  static inline uint32_t scale(uint32_t raw, uint32_t range) {
+    return static_cast<uint32_t>((uint64_t{raw} * range) >> 32);
+  }
+
+  /**
+   * @brief Raw 32 bit values from the four lane generator of the thread, AVX2 when the
+   * cpu has it. Range other than zero scales them into [0, range) the way scale does
+   */
+  static void fill(uint32_t *out, size_t count, uint32_t range = 0) {
+    auto &lanes = state().lanes;
+    size_t i = 0;
+    if (Simd::level() != Simd::Level::Scalar) {
+      i = rng_detail::fillAvx2(lanes, out, count, range);
+    }
+    alignas(32) uint32_t step[8];
+    for (; i < count; i += 8) {
+      rng_detail::stepScalar(lanes, step, range);
+      for (size_t j = 0; j < 8 && i + j < count; ++j) {
+        out[i + j] = step[j];
+      }
+    }
   }
 
 private:
-  static std::random_device kRandomDevice;
-  static std::mt19937 kRandomAlgo;
+  /**
+   * @brief Scalar generator takes the stream itself, bulk lanes take the next four
+   */
+  struct ThreadState {
+    ThreadState() { reseed(sSeed.load(), sNextStream.fetch_add(1)); }
+
+    void reseed(uint64_t seed, uint64_t stream) {
+      Xoshiro256pp base{seed};
+      const uint64_t first = stream * (LANE_STREAMS + 1);
+      for (uint64_t i = 0; i < first; ++i) {
+        base.jump();
+      }
+      generator = base;
+      for (size_t lane = 0; lane < LANE_STREAMS; ++lane) {
+        base.jump();
+        Xoshiro256pp copy = base;
+        for (size_t word = 0; word < 4; ++word) {
+          lanes.words[word][lane] = copy();
+        }
+      }
+    }
+
+    Xoshiro256pp generator;
+    rng_detail::Lanes lanes;
+  };
+
+  static inline ThreadState &state() {
+    thread_local ThreadState state;
+    return state;
+  }
+
+  static inline uint32_t next32() { return static_cast<uint32_t>(next() >> 32); }
+
+  static std::atomic_uint64_t sSeed;
+  static std::atomic_uint64_t sNextStream;
 };
 
 } // namespace hft::utils
 
-#endif // HFT_COMMON_RNG_HPP
\ No newline at end of file
+#endif // HFT_COMMON_RNG_HPP
@@ -0,0 +1,90 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-19
+ */
+
+#ifndef HFT_COMMON_SEQLOCK_HPP
+#define HFT_COMMON_SEQLOCK_HPP
+
+#include <immintrin.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace hft::utils {
+
+/**
+ * @brief Small value read without locking. Writer makes the version odd for the time
+ * of the write and readers retry if it moved while they copied. Writers take the odd
+ * version with a compare exchange, so several threads may write. Value is kept in atomic
+ * words, so a torn copy is discarded rather than undefined
+ */
+template <typename Type>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<Type>);
+  static_assert(sizeof(Type) % sizeof(uint32_t) == 0);
+  static constexpr size_t WORDS = sizeof(Type) / sizeof(uint32_t);
+
+public:
+  Type load() const {
+    std::array<uint32_t, WORDS> words;
+    for (;;) {
+      const uint32_t version = mVersion.load(std::memory_order_acquire);
+      if ((version & 1) != 0) {
+        _mm_pause();
+        continue;
+      }
+      for (size_t i = 0; i < WORDS; ++i) {
+        words[i] = mWords[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (mVersion.load(std::memory_order_relaxed) == version) {
+        break;
+      }
+    }
+    Type value;
+    std::memcpy(&value, words.data(), sizeof(Type));
+    return value;
+  }
+
+  void store(const Type &value) {
+    modify([&value](Type &current) { current = value; });
+  }
+
+  /**
+   * @brief Read, change and write back under the write side of the lock
+   */
+  template <typename Callable>
+  void modify(Callable &&change) {
+    uint32_t version = mVersion.load(std::memory_order_relaxed);
+    while ((version & 1) != 0 ||
+           !mVersion.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+      _mm_pause();
+      version = mVersion.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::array<uint32_t, WORDS> words;
+    for (size_t i = 0; i < WORDS; ++i) {
+      words[i] = mWords[i].load(std::memory_order_relaxed);
+    }
+    Type value;
+    std::memcpy(&value, words.data(), sizeof(Type));
+    change(value);
+    std::memcpy(words.data(), &value, sizeof(Type));
+    for (size_t i = 0; i < WORDS; ++i) {
+      mWords[i].store(words[i], std::memory_order_relaxed);
+    }
+    mVersion.store(version + 2, std::memory_order_release);
+  }
+
+private:
+  std::atomic<uint32_t> mVersion{0};
+  std::array<std::atomic<uint32_t>, WORDS> mWords{};
+};
+
+} // namespace hft::utils
+
+#endif // HFT_COMMON_SEQLOCK_HPP
@@ -0,0 +1,264 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-16
+ */
+
+#ifndef HFT_COMMON_SIMD_HPP
+#define HFT_COMMON_SIMD_HPP
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hft::utils {
+
+namespace simd_detail {
+
+inline size_t countLessScalar(const uint32_t *data, size_t size, uint32_t value) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    count += data[i] < value;
+  }
+  return count;
+}
+
+inline size_t countGreaterScalar(const uint32_t *data, size_t size, uint32_t value) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    count += data[i] > value;
+  }
+  return count;
+}
+
+inline uint64_t sumScalar(const uint32_t *data, size_t size) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < size; ++i) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+// AVX2 has only signed compares, flipping the sign bit maps unsigned order onto signed
+__attribute__((target("avx2"))) inline size_t countLessAvx2(const uint32_t *data, size_t size,
+                                                            uint32_t value) {
+  const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+  const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32(value), bias);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256i lanes = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), bias);
+    const __m256i less = _mm256_cmpgt_epi32(needle, lanes);
+    count += std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(less))));
+  }
+  return count + countLessScalar(data + i, size - i, value);
+}
+
+__attribute__((target("avx2"))) inline size_t countGreaterAvx2(const uint32_t *data, size_t size,
+                                                               uint32_t value) {
+  const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+  const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32(value), bias);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256i lanes = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), bias);
+    const __m256i greater = _mm256_cmpgt_epi32(lanes, needle);
+    count +=
+        std::popcount(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(greater))));
+  }
+  return count + countGreaterScalar(data + i, size - i, value);
+}
+
+__attribute__((target("avx2"))) inline uint64_t sumAvx2(const uint32_t *data, size_t size) {
+  __m256i low = _mm256_setzero_si256();
+  __m256i high = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    low = _mm256_add_epi64(low, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(lanes)));
+    high = _mm256_add_epi64(high, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(lanes, 1)));
+  }
+  alignas(32) uint64_t parts[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(parts), _mm256_add_epi64(low, high));
+  return parts[0] + parts[1] + parts[2] + parts[3] + sumScalar(data + i, size - i);
+}
+
+// Tails go through masked loads, so no scalar loop is left over
+__attribute__((target("avx512f"))) inline size_t countLessAvx512(const uint32_t *data,
+                                                                 size_t size, uint32_t value) {
+  const __m512i needle = _mm512_set1_epi32(value);
+  size_t count = 0;
+  for (size_t i = 0; i < size; i += 16) {
+    const __mmask16 valid = size - i >= 16 ? 0xFFFF : (1U << (size - i)) - 1;
+    const __m512i lanes = _mm512_maskz_loadu_epi32(valid, data + i);
+    const __mmask16 hits = _mm512_mask_cmplt_epu32_mask(valid, lanes, needle);
+    count += std::popcount(static_cast<uint32_t>(hits));
+  }
+  return count;
+}
+
+__attribute__((target("avx512f"))) inline size_t countGreaterAvx512(const uint32_t *data,
+                                                                    size_t size, uint32_t value) {
+  const __m512i needle = _mm512_set1_epi32(value);
+  size_t count = 0;
+  for (size_t i = 0; i < size; i += 16) {
+    const __mmask16 valid = size - i >= 16 ? 0xFFFF : (1U << (size - i)) - 1;
+    const __m512i lanes = _mm512_maskz_loadu_epi32(valid, data + i);
+    const __mmask16 hits = _mm512_mask_cmpgt_epu32_mask(valid, lanes, needle);
+    count += std::popcount(static_cast<uint32_t>(hits));
+  }
+  return count;
+}
+
+__attribute__((target("avx512f"))) inline uint64_t sumAvx512(const uint32_t *data, size_t size) {
+  __m512i low = _mm512_setzero_si512();
+  __m512i high = _mm512_setzero_si512();
+  for (size_t i = 0; i < size; i += 16) {
+    const __mmask16 valid = size - i >= 16 ? 0xFFFF : (1U << (size - i)) - 1;
+    const __m512i lanes = _mm512_maskz_loadu_epi32(valid, data + i);
+    low = _mm512_add_epi64(low, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(lanes)));
+    high = _mm512_add_epi64(high, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(lanes, 1)));
+  }
+  return _mm512_reduce_add_epi64(_mm512_add_epi64(low, high));
+}
+
+} // namespace simd_detail
+
+/**
+ * @brief Scan kernels over uint32 arrays of the book: prices and level volumes
+ * Instruction set is picked once from CPUID, a lower one can be forced for comparison.
+ * Every kernel is a single predictable switch away from its implementation
+ */
+struct Simd {
+  enum class Level : uint8_t { Scalar, Avx2, Avx512 };
+
+  /**
+   * @brief Sorted arrays are narrowed with binary search down to this window,
+   * the rest is counted in a branch free scan
+   */
+  static constexpr size_t SEARCH_WINDOW = 64;
+
+  static Level detect() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return Level::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return Level::Avx2;
+    }
+    return Level::Scalar;
+  }
+
+  static Level level() { return sLevel; }
+
+  /**
+   * @brief Levels above the supported one are clamped, returns the level in use
+   */
+  static Level setLevel(Level level) {
+    sLevel = std::min(level, detect());
+    return sLevel;
+  }
+
+  static Level parse(const std::string &name) {
+    if (name == "scalar") {
+      return Level::Scalar;
+    }
+    if (name == "avx2") {
+      return Level::Avx2;
+    }
+    return Level::Avx512;
+  }
+
+  static const char *toString(Level level) {
+    switch (level) {
+    case Level::Avx512:
+      return "avx512";
+    case Level::Avx2:
+      return "avx2";
+    default:
+      return "scalar";
+    }
+  }
+
+  static inline size_t countLess(const uint32_t *data, size_t size, uint32_t value) {
+    using namespace simd_detail;
+    switch (sLevel) {
+    case Level::Avx512:
+      return countLessAvx512(data, size, value);
+    case Level::Avx2:
+      return countLessAvx2(data, size, value);
+    default:
+      return countLessScalar(data, size, value);
+    }
+  }
+
+  static inline size_t countGreater(const uint32_t *data, size_t size, uint32_t value) {
+    using namespace simd_detail;
+    switch (sLevel) {
+    case Level::Avx512:
+      return countGreaterAvx512(data, size, value);
+    case Level::Avx2:
+      return countGreaterAvx2(data, size, value);
+    default:
+      return countGreaterScalar(data, size, value);
+    }
+  }
+
+  static inline uint64_t sum(const uint32_t *data, size_t size) {
+    using namespace simd_detail;
+    switch (sLevel) {
+    case Level::Avx512:
+      return sumAvx512(data, size);
+    case Level::Avx2:
+      return sumAvx2(data, size);
+    default:
+      return sumScalar(data, size);
+    }
+  }
+
+  /**
+   * @brief Position of the first element not below value in an ascending array
+   */
+  static inline size_t lowerBoundAscending(const uint32_t *data, size_t size, uint32_t value) {
+    size_t first = 0;
+    while (size > SEARCH_WINDOW) {
+      const size_t half = size / 2;
+      if (data[first + half] < value) {
+        first += half + 1;
+        size -= half + 1;
+      } else {
+        size = half;
+      }
+    }
+    return first + countLess(data + first, size, value);
+  }
+
+  /**
+   * @brief Position of the first element not above value in a descending array
+   */
+  static inline size_t lowerBoundDescending(const uint32_t *data, size_t size, uint32_t value) {
+    size_t first = 0;
+    while (size > SEARCH_WINDOW) {
+      const size_t half = size / 2;
+      if (data[first + half] > value) {
+        first += half + 1;
+        size -= half + 1;
+      } else {
+        size = half;
+      }
+    }
+    return first + countGreater(data + first, size, value);
+  }
+
+private:
+  static inline Level sLevel{detect()};
+};
+
+} // namespace hft::utils
+
+#endif // HFT_COMMON_SIMD_HPP
@@ -6,6 +6,7 @@
 #ifndef HFT_COMMON_STRING_UTILS_HPP
 #define HFT_COMMON_STRING_UTILS_HPP
 
+#include <format>
 #include <functional>
 #include <spdlog/spdlog.h>
 #include <sstream>
@@ -29,6 +30,10 @@ std::string toString<OrderState>(const OrderState &state) {
     return "Full";
   case OrderState::Partial:
     return "Partial";
+  case OrderState::Rejected:
+    return "Rejected";
+  case OrderState::Cancelled:
+    return "Cancelled";
   default:
     spdlog::error("Unknown OrderState {}", (uint8_t)state);
   }
@@ -48,6 +53,40 @@ std::string toString<OrderAction>(const OrderAction &state) {
   return "";
 }
 
+template <>
+std::string toString<OrderType>(const OrderType &type) {
+  switch (type) {
+  case OrderType::Limit:
+    return "Limit";
+  case OrderType::Market:
+    return "Market";
+  case OrderType::PostOnly:
+    return "PostOnly";
+  case OrderType::Stop:
+    return "Stop";
+  case OrderType::StopLimit:
+    return "StopLimit";
+  default:
+    spdlog::error("Unknown OrderType {}", (uint8_t)type);
+  }
+  return "";
+}
+
+template <>
+std::string toString<TimeInForce>(const TimeInForce &tif) {
+  switch (tif) {
+  case TimeInForce::Gtc:
+    return "GTC";
+  case TimeInForce::Ioc:
+    return "IOC";
+  case TimeInForce::Fok:
+    return "FOK";
+  default:
+    spdlog::error("Unknown TimeInForce {}", (uint8_t)tif);
+  }
+  return "";
+}
+
 std::string_view toStrView(const Ticker &ticker) {
   return std::string_view(ticker.data(), TICKER_SIZE);
 }
@@ -57,6 +96,18 @@ std::string toString<Order>(const Order &order) {
   std::stringstream ss;
   ss << toString(order.action) << " " << order.quantity << " shares of " << toStrView(order.ticker)
      << " at $" << order.price;
+  if (order.type != OrderType::Limit) {
+    ss << " " << toString(order.type);
+  }
+  if (order.tif != TimeInForce::Gtc) {
+    ss << " " << toString(order.tif);
+  }
+  if (order.trigger != 0) {
+    ss << " trigger $" << order.trigger;
+  }
+  if (order.display != 0) {
+    ss << " showing " << order.display;
+  }
   return ss.str();
 }
 
@@ -69,8 +120,15 @@ std::string toString<OrderStatus>(const OrderStatus &order) {
   if ((uint8_t)order.state & (uint8_t)OrderState::Full) {
     state += "Fully ";
   }
-  if (state.empty()) {
+  if ((uint8_t)order.state & (uint8_t)OrderState::Rejected) {
+    state = "Rejected ";
+  } else if ((uint8_t)order.state & (uint8_t)OrderState::Cancelled) {
+    state = (uint8_t)order.state & (uint8_t)OrderState::Partial ? "Partially cancelled "
+                                                                 : "Cancelled ";
+  } else if (state.empty()) {
     state = "Accepted ";
+  } else if ((uint8_t)order.state & (uint8_t)OrderState::Resting) {
+    state += "filled resting ";
   } else {
     state += "filled ";
   }
@@ -81,7 +139,8 @@ std::string toString<OrderStatus>(const OrderStatus &order) {
 template <>
 std::string toString<TickerPrice>(const TickerPrice &price) {
   std::stringstream ss;
-  ss << toStrView(price.ticker) << ": $" << price.price;
+  ss << toStrView(price.ticker) << ": $" << price.price << " " << price.bidQuantity << "@"
+     << price.bid << " " << price.askQuantity << "@" << price.ask;
   return ss.str();
 }
 
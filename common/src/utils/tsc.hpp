@@ -0,0 +1,38 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-21
+ */
+
+#ifndef HFT_COMMON_TSC_HPP
+#define HFT_COMMON_TSC_HPP
+
+#include <x86intrin.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace hft::utils {
+
+/**
+ * @brief Time stamp counter, invariant on the cpus we run on, so stamps taken on
+ * different cores compare
+ */
+inline uint64_t rdtsc() { return __rdtsc(); }
+
+/**
+ * @brief Counter ticks per nanosecond measured against the steady clock
+ */
+inline double tscPerNs(std::chrono::milliseconds interval = std::chrono::milliseconds(20)) {
+  const auto clockStart = std::chrono::steady_clock::now();
+  const uint64_t tscStart = rdtsc();
+  std::this_thread::sleep_for(interval);
+  const uint64_t tscEnd = rdtsc();
+  const auto elapsed = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - clockStart);
+  return (tscEnd - tscStart) / elapsed.count();
+}
+
+} // namespace hft::utils
+
+#endif // HFT_COMMON_TSC_HPP
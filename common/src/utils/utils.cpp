@@ -39,16 +39,6 @@ void setTheadRealTime() {
   }
 }
 
-size_t getTickerHash(const Ticker &ticker) {
-  return std::hash<std::string_view>{}(std::string_view(ticker.data(), ticker.size()));
-}
-
-TraderId getTraderId(const TcpSocket &sock) {
-  auto endpoint = sock.remote_endpoint();
-  std::string idString = endpoint.address().to_string();
-  return static_cast<uint32_t>(std::hash<std::string>{}(idString));
-}
-
 Order createOrder(TraderId trId, const Ticker &tkr, Quantity quan, Price price, OrderAction act) {
   return {trId, getLinuxTimestamp(), tkr, quan, price, act};
 }
@@ -25,14 +25,11 @@ namespace hft::utils {
 void pinThreadToCore(int core_id);
 void setTheadRealTime();
 
-TraderId getTraderId(const TcpSocket &sock);
-
 inline size_t generateOrderId() {
   static std::atomic<size_t> counter{0};
   return counter.fetch_add(1, std::memory_order_relaxed);
 };
 
-size_t getTickerHash(const Ticker &ticker);
 Order createOrder(TraderId trId, const Ticker &tkr, Quantity quan, Price price, OrderAction act);
 Ticker generateTicker();
 Order generateOrder(Ticker ticker);
@@ -0,0 +1,348 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-10
+ */
+
+#ifndef HFT_SERVER_JOURNAL_HPP
+#define HFT_SERVER_JOURNAL_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+#include "market_types.hpp"
+#include "types.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Fixed size journal record. Sequence is per book and survives ticker migration,
+ * so replay can merge records of one ticker written by different workers
+ */
+struct JournalRecord {
+  enum class Type : uint32_t { Empty = 0, Order = 1, Fill = 2 };
+  static constexpr size_t PAYLOAD_SIZE = std::max(sizeof(Order), sizeof(OrderStatus));
+
+  Type type{Type::Empty};
+  uint32_t checksum{0};
+  uint64_t sequence{0};
+  alignas(8) std::byte payload[PAYLOAD_SIZE];
+
+  uint32_t computeChecksum() const {
+    // FNV-1a over everything but the checksum itself
+    uint32_t hash = 2166136261u ^ static_cast<uint32_t>(type);
+    auto mix = [&hash](uint32_t word) { hash = (hash ^ word) * 16777619u; };
+    mix(static_cast<uint32_t>(sequence));
+    mix(static_cast<uint32_t>(sequence >> 32));
+    for (size_t i = 0; i < PAYLOAD_SIZE; i += sizeof(uint32_t)) {
+      uint32_t word;
+      std::memcpy(&word, payload + i, sizeof(word));
+      mix(word);
+    }
+    return hash;
+  }
+};
+static_assert(JournalRecord::PAYLOAD_SIZE % sizeof(uint32_t) == 0);
+
+/**
+ * @brief First slot of every segment, records follow it. Segments written with another
+ * format are skipped on replay instead of being misread
+ */
+struct SegmentHeader {
+  static constexpr uint32_t MAGIC = 0x4A544648; // HFTJ
+  static constexpr uint32_t VERSION = 2;
+
+  uint32_t magic{MAGIC};
+  uint32_t version{VERSION};
+  uint64_t recordSize{sizeof(JournalRecord)};
+
+  bool valid() const {
+    return magic == MAGIC && version == VERSION && recordSize == sizeof(JournalRecord);
+  }
+};
+static_assert(sizeof(SegmentHeader) <= sizeof(JournalRecord));
+
+/**
+ * @brief Append only journal of a single worker
+ * Segments are preallocated and memory mapped, so appending is a memcpy. Durability is
+ * provided by sync() called from a separate thread, which also prepares the next segment
+ * ahead of time and releases the sealed ones, so worker never waits on the disk
+ */
+class Journal {
+  struct Segment {
+    int fd{-1};
+    void *data{nullptr};
+    JournalRecord *records{nullptr};
+    size_t capacity{0};
+    size_t index{0};
+    std::atomic_size_t written{0};
+
+    ~Segment() {
+      if (data != nullptr) {
+        munmap(data, (capacity + 1) * sizeof(JournalRecord));
+      }
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+  };
+
+public:
+  using UPtr = std::unique_ptr<Journal>;
+
+  static constexpr const char *EXTENSION = ".journal";
+
+  Journal(const std::string &dir, ThreadId workerId, size_t segmentSize)
+      : mDir{dir}, mWorkerId{workerId},
+        mCapacity{std::max<size_t>(segmentSize / sizeof(JournalRecord), 1)},
+        mNextIndex{nextSegmentIndex(dir, workerId)} {
+    mCurrent = openSegment().release();
+    mActive.store(mCurrent, std::memory_order_release);
+    mActiveIndex.store(mCurrent->index, std::memory_order_release);
+  }
+
+  ~Journal() {
+    sync();
+    delete mNext.exchange(nullptr);
+    delete mCurrent;
+  }
+
+  inline void appendOrder(uint64_t sequence, const Order &order) {
+    append(JournalRecord::Type::Order, sequence, order);
+  }
+
+  inline void appendFill(uint64_t sequence, const OrderStatus &status) {
+    append(JournalRecord::Type::Fill, sequence, status);
+  }
+
+  /**
+   * @brief Group commit, called periodically from the journal thread
+   */
+  void sync() {
+    // Active segment is sealed and released only below, on this same thread
+    Segment *active = mActive.load(std::memory_order_acquire);
+    if (active->written.load(std::memory_order_acquire) != 0) {
+      fdatasync(active->fd);
+    }
+    std::vector<Segment *> sealed;
+    {
+      std::lock_guard lock{mSealedMtx};
+      sealed.swap(mSealed);
+    }
+    for (auto *segment : sealed) {
+      fdatasync(segment->fd);
+      delete segment;
+    }
+    if (mNext.load(std::memory_order_acquire) == nullptr) {
+      mNext.store(openSegment().release(), std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Index of the segment being appended to, lower ones of this worker are sealed
+   */
+  size_t activeIndex() const { return mActiveIndex.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Reads all complete records in the directory, stops at the first empty or torn
+   * record of each segment. Records of different segments are not ordered, segments with
+   * unknown magic or version are skipped
+   */
+  static std::vector<JournalRecord> read(const std::string &dir) {
+    std::vector<JournalRecord> records;
+    for (auto &path : list(dir)) {
+      scan(path, [&records](const JournalRecord &record) {
+        records.push_back(record);
+        return true;
+      });
+    }
+    return records;
+  }
+
+  /**
+   * @brief Deletes sealed segments whose every record is covered, for a live worker those
+   * below its active index. Segments of unknown format are kept, returns the deleted count
+   */
+  template <typename Covered>
+  static size_t retire(const std::string &dir, const std::vector<size_t> &activeIndices,
+                       Covered &&covered) {
+    size_t retired = 0;
+    for (auto &path : list(dir)) {
+      const auto name = path.stem().string();
+      const size_t split = name.find('_');
+      if (!name.starts_with('w') || split == std::string::npos) {
+        continue;
+      }
+      const size_t workerId = std::stoull(name.substr(1, split - 1));
+      const size_t index = std::stoull(name.substr(split + 1));
+      if (workerId < activeIndices.size() && index >= activeIndices[workerId]) {
+        continue;
+      }
+      bool all = true;
+      const bool valid = scan(path, [&all, &covered](const JournalRecord &record) {
+        all = covered(record);
+        return all;
+      });
+      if (valid && all) {
+        std::filesystem::remove(path);
+        ++retired;
+      }
+    }
+    return retired;
+  }
+
+private:
+  static std::vector<std::filesystem::path> list(const std::string &dir) {
+    std::vector<std::filesystem::path> paths;
+    if (!std::filesystem::exists(dir)) {
+      return paths;
+    }
+    for (auto &entry : std::filesystem::directory_iterator(dir)) {
+      if (entry.path().extension() == EXTENSION) {
+        paths.push_back(entry.path());
+      }
+    }
+    return paths;
+  }
+
+  /**
+   * @brief Passes complete records of a segment to onRecord while it returns true,
+   * returns false for a segment of unknown format
+   */
+  template <typename Callable>
+  static bool scan(const std::filesystem::path &path, Callable &&onRecord) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      throw std::runtime_error(std::format("Failed to open {}", path.string()));
+    }
+    const size_t size = std::filesystem::file_size(path);
+    const size_t count = size / sizeof(JournalRecord);
+    if (count == 0) {
+      close(fd);
+      return true;
+    }
+    void *data = mmap(nullptr, count * sizeof(JournalRecord), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error(std::format("Failed to map {}", path.string()));
+    }
+    SegmentHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (!header.valid()) {
+      Logger::monitorLogger->error("Skipped journal segment {} of magic {:#x} version {}",
+                                   path.string(), header.magic, header.version);
+      munmap(data, count * sizeof(JournalRecord));
+      return false;
+    }
+    madvise(data, count * sizeof(JournalRecord), MADV_SEQUENTIAL);
+    const auto *segment = static_cast<const JournalRecord *>(data);
+    for (size_t i = 1; i < count; ++i) {
+      const auto &record = segment[i];
+      if (record.type == JournalRecord::Type::Empty ||
+          record.checksum != record.computeChecksum() || !onRecord(record)) {
+        break;
+      }
+    }
+    munmap(data, count * sizeof(JournalRecord));
+    return true;
+  }
+
+  template <typename Payload>
+  inline void append(JournalRecord::Type type, uint64_t sequence, const Payload &payload) {
+    size_t written = mCurrent->written.load(std::memory_order_relaxed);
+    if (written == mCurrent->capacity) [[unlikely]] {
+      rollover();
+      written = 0;
+    }
+    JournalRecord &record = mCurrent->records[written];
+    record.sequence = sequence;
+    std::memcpy(record.payload, &payload, sizeof(Payload));
+    record.type = type;
+    record.checksum = record.computeChecksum();
+    mCurrent->written.store(written + 1, std::memory_order_release);
+  }
+
+  void rollover() {
+    Segment *next = mNext.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr) {
+      next = openSegment().release();
+    }
+    {
+      std::lock_guard lock{mSealedMtx};
+      mSealed.push_back(mCurrent);
+    }
+    mCurrent = next;
+    mActive.store(mCurrent, std::memory_order_release);
+    mActiveIndex.store(mCurrent->index, std::memory_order_release);
+  }
+
+  std::unique_ptr<Segment> openSegment() {
+    const size_t index = mNextIndex.fetch_add(1, std::memory_order_relaxed);
+    const auto path = std::format("{}/w{}_{:08}{}", mDir, mWorkerId, index, EXTENSION);
+    auto segment = std::make_unique<Segment>();
+    segment->capacity = mCapacity;
+    segment->index = index;
+    const size_t bytes = (mCapacity + 1) * sizeof(JournalRecord);
+
+    segment->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (segment->fd == -1) {
+      throw std::runtime_error(std::format("Failed to create journal segment {}", path));
+    }
+    if (posix_fallocate(segment->fd, 0, bytes) != 0) {
+      throw std::runtime_error(std::format("Failed to allocate journal segment {}", path));
+    }
+    void *data =
+        mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, segment->fd, 0);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error(std::format("Failed to map journal segment {}", path));
+    }
+    const SegmentHeader header;
+    std::memcpy(data, &header, sizeof(header));
+    segment->data = data;
+    segment->records = static_cast<JournalRecord *>(data) + 1;
+    return segment;
+  }
+
+  static size_t nextSegmentIndex(const std::string &dir, ThreadId workerId) {
+    std::filesystem::create_directories(dir);
+    const auto prefix = std::format("w{}_", workerId);
+    size_t next = 0;
+    for (auto &entry : std::filesystem::directory_iterator(dir)) {
+      const auto name = entry.path().stem().string();
+      if (entry.path().extension() == EXTENSION && name.starts_with(prefix)) {
+        next = std::max<size_t>(next, std::stoull(name.substr(prefix.size())) + 1);
+      }
+    }
+    return next;
+  }
+
+private:
+  const std::string mDir;
+  const ThreadId mWorkerId;
+  const size_t mCapacity;
+  std::atomic_size_t mNextIndex;
+
+  Segment *mCurrent{nullptr};
+  std::atomic<Segment *> mActive{nullptr};
+  std::atomic_size_t mActiveIndex{0};
+  std::atomic<Segment *> mNext{nullptr};
+
+  std::mutex mSealedMtx;
+  std::vector<Segment *> mSealed;
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_JOURNAL_HPP
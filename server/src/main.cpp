@@ -13,12 +13,15 @@ int main() {
   using namespace hft;
   std::unique_ptr<server::Server> hftServer;
   try {
-    Logger::initialize(spdlog::level::err, "server_log.txt");
+    Logger::initialize(spdlog::level::err, "server_log.txt", Logger::Backend::Binary);
     ConfigReader::readConfig("server_config.ini");
 
     Logger::monitorLogger->info("Server configuration:");
     Config::cfg.logConfig();
+    BufferPool::configure(Config::cfg.poolArenaMb << 20, Config::cfg.poolHugePages);
     Logger::monitorLogger->info("LogLevel:{}", utils::toString(spdlog::get_level()));
+    const auto simd = utils::Simd::setLevel(utils::Simd::parse(Config::cfg.simdLevel));
+    Logger::monitorLogger->info("Simd kernels:{}", utils::Simd::toString(simd));
 
     hftServer = std::make_unique<server::Server>();
     hftServer->start();
@@ -28,5 +31,6 @@ int main() {
     spdlog::default_logger()->flush();
     hftServer->stop();
   }
+  Logger::shutdown();
   return 0;
 }
\ No newline at end of file
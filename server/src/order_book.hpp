@@ -7,99 +7,608 @@
 #define HFT_SERVER_FLATORDERBOOK_HPP
 
 #include <algorithm>
-#include <map>
-#include <set>
+#include <format>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "constants.hpp"
+#include "logger.hpp"
 #include "market_types.hpp"
+#include "order_slab.hpp"
+#include "pool/buffer_pool.hpp"
 #include "types.hpp"
-#include "utils/rng.hpp"
+#include "utils/simd.hpp"
 #include "utils/string_utils.hpp"
 
 namespace hft::server {
 
-class FlatOrderBook {
-  static bool compareBids(const Order &left, const Order &right) {
-    return left.price < right.price;
+/**
+ * @brief What happens when an incoming order would trade against a resting order of the
+ * same trader. Decrement takes the smaller quantity off both without a trade
+ */
+enum class SelfTradePrevention : uint8_t {
+  Allow,
+  CancelNewest,
+  CancelOldest,
+  CancelBoth,
+  Decrement
+};
+
+inline SelfTradePrevention parseSelfTradePrevention(const std::string &mode) {
+  if (mode == "allow") {
+    return SelfTradePrevention::Allow;
+  }
+  if (mode == "cancel_newest") {
+    return SelfTradePrevention::CancelNewest;
+  }
+  if (mode == "cancel_oldest") {
+    return SelfTradePrevention::CancelOldest;
+  }
+  if (mode == "cancel_both") {
+    return SelfTradePrevention::CancelBoth;
   }
-  static bool compareAsks(const Order &left, const Order &right) {
-    return left.price > right.price;
+  if (mode == "decrement") {
+    return SelfTradePrevention::Decrement;
   }
+  throw std::runtime_error(std::format("Unknown self trade prevention mode {}", mode));
+}
+
+/**
+ * @brief Price levels are kept sorted with the best price at the back, prices, volumes and
+ * level queues in separate arrays so level search and liquidity checks run SIMD scans over
+ * plain uint32 arrays. Each level is a FIFO queue of slab indices linked through the slab,
+ * orders stay in place in the slab of the owning worker and matching only relinks indices
+ */
+template <typename Slab = OrderSlab>
+class alignas(CACHE_LINE_SIZE) FlatOrderBook {
+  struct LevelQueue {
+    OrderIndex head;
+    OrderIndex tail;
+  };
+  struct Side {
+    PoolVector<Price> prices;
+    PoolVector<Quantity> volumes;
+    PoolVector<LevelQueue> queues;
+    uint64_t hidden{0};
+  };
+  struct Stops {
+    PoolVector<Price> triggers;
+    PoolVector<Order> orders;
+  };
 
 public:
   using UPtr = std::unique_ptr<FlatOrderBook>;
 
   FlatOrderBook() {
-    mBids.reserve(500);
-    mAsks.reserve(500);
+    for (auto *side : {&mBids, &mAsks}) {
+      side->prices.reserve(64);
+      side->volumes.reserve(64);
+      side->queues.reserve(64);
+    }
   }
   ~FlatOrderBook() = default;
 
-  void add(const Order &order) {
+  /**
+   * @brief Matches an incoming order against the opposite side, the remainder rests only
+   * for a Gtc limit or post only order and is cancelled otherwise. Stop orders are held
+   * until the last trade price reaches the trigger. Statuses are reported for the incoming
+   * order, stops it triggered and fills of resting orders, which carry the Resting flag.
+   * Resting orders that get fully filled go to onRestingClosed
+   */
+  template <typename Callable>
+  std::vector<OrderStatus> execute(const Order &order, Callable &&onRestingClosed) {
+    std::vector<OrderStatus> statuses;
+    statuses.reserve(10);
+    if (order.type == OrderType::Stop || order.type == OrderType::StopLimit) {
+      hold(order);
+    } else {
+      process(order, statuses, onRestingClosed);
+    }
+    // Each triggered stop may move the last price and trigger the next one,
+    // so the whole cascade is a loop over the backs of the trigger arrays
+    Order triggered;
+    while (popTriggered(triggered)) {
+      process(triggered, statuses, onRestingClosed);
+    }
+    return statuses;
+  }
+
+  std::vector<OrderStatus> execute(const Order &order) {
+    return execute(order, [](const Order &) {});
+  }
+
+  /**
+   * @brief Rests an order without matching it, returns false if the slab is full
+   */
+  bool add(const Order &order) { return add(order, displayed(order)); }
+
+  /**
+   * @brief Resting quantity an order of the given side could take down to its limit price,
+   * level volumes include iceberg reserves as a sweep fills them as well
+   */
+  uint64_t liquidity(OrderAction action, Price limit) const {
+    if (action == OrderAction::Buy) {
+      const size_t from =
+          utils::Simd::lowerBoundDescending(mAsks.prices.data(), mAsks.prices.size(), limit);
+      return utils::Simd::sum(mAsks.volumes.data() + from, mAsks.volumes.size() - from);
+    }
+    const size_t from =
+        utils::Simd::lowerBoundAscending(mBids.prices.data(), mBids.prices.size(), limit);
+    return utils::Simd::sum(mBids.volumes.data() + from, mBids.volumes.size() - from);
+  }
+
+  /**
+   * @brief Resting orders from the best level down in queue order, restoring them in this
+   * order keeps the matching order identical
+   */
+  std::vector<RestingOrder> bids() const { return collect(mBids); }
+  std::vector<RestingOrder> asks() const { return collect(mAsks); }
+
+  /**
+   * @brief Held stop orders in the order they would fire
+   */
+  std::vector<Order> stops() const {
+    std::vector<Order> orders(mBuyStops.orders.rbegin(), mBuyStops.orders.rend());
+    orders.insert(orders.end(), mSellStops.orders.rbegin(), mSellStops.orders.rend());
+    return orders;
+  }
+
+  Price lastPrice() const { return mLastPrice; }
+
+  /**
+   * @brief Last trade price and the best level of each side, ticker is left to the caller
+   */
+  void quote(TickerPrice &quote) const {
+    quote.price = mLastPrice;
+    quote.bid = mBids.prices.empty() ? 0 : mBids.prices.back();
+    quote.bidQuantity = mBids.prices.empty() ? 0 : shown(mBids);
+    quote.ask = mAsks.prices.empty() ? 0 : mAsks.prices.back();
+    quote.askQuantity = mAsks.prices.empty() ? 0 : shown(mAsks);
+  }
+
+  void restore(const std::vector<RestingOrder> &bids, const std::vector<RestingOrder> &asks,
+               const std::vector<Order> &stops, Price lastPrice) {
+    clear();
+    for (auto *side : {&bids, &asks}) {
+      for (auto &resting : *side) {
+        if (!add(resting.order, resting.shown)) {
+          throw std::runtime_error("Order slab is too small to restore the books");
+        }
+      }
+    }
+    for (auto *side : {&mBuyStops, &mSellStops}) {
+      side->triggers.clear();
+      side->orders.clear();
+    }
+    for (auto &order : stops) {
+      hold(order);
+    }
+    mLastPrice = lastPrice;
+  }
+
+  const Slab *slab() const { return mSlab; }
+
+  void setSelfTradePrevention(SelfTradePrevention mode) { mSelfTrade = mode; }
+
+  /**
+   * @brief Moves resting orders out of the slab of the current owner, called by it
+   * right before the book is handed over to another worker. Priority and the shown part
+   * of iceberg peaks are kept
+   */
+  void park() {
+    if (mSlab == nullptr) {
+      return;
+    }
+    mParked = collect(mBids);
+    auto asks = collect(mAsks);
+    mParked.insert(mParked.end(), asks.begin(), asks.end());
+    clear();
+    mSlab = nullptr;
+  }
+
+  /**
+   * @brief Binds the book to the slab of the new owner and takes parked orders back in,
+   * orders that do not fit are handed to onDropped
+   */
+  template <typename Callable>
+  void adopt(Slab &slab, Callable &&onDropped) {
+    mSlab = &slab;
+    for (auto &resting : mParked) {
+      if (!add(resting.order, resting.shown)) {
+        onDropped(resting.order);
+      }
+    }
+    mParked.clear();
+  }
+
+  void adopt(Slab &slab) {
+    adopt(slab, [](const Order &) {});
+  }
+
+private:
+  bool add(const Order &order, Quantity shown) {
+    const OrderIndex index = mSlab->allocate();
+    if (index == INVALID_ORDER_INDEX) [[unlikely]] {
+      return false;
+    }
+    mSlab->store(index, order, shown);
+    if (order.action == OrderAction::Buy) {
+      auto &prices = mBids.prices;
+      link(mBids, order, shown, index,
+           utils::Simd::lowerBoundAscending(prices.data(), prices.size(), order.price));
+    } else {
+      auto &prices = mAsks.prices;
+      link(mAsks, order, shown, index,
+           utils::Simd::lowerBoundDescending(prices.data(), prices.size(), order.price));
+    }
+    return true;
+  }
+
+  template <typename Callable>
+  void process(const Order &order, std::vector<OrderStatus> &statuses,
+               Callable &&onRestingClosed) {
+    Side &opposite = order.action == OrderAction::Buy ? mAsks : mBids;
+    const bool crosses = !opposite.prices.empty() && crossing(order, opposite.prices.back());
+
+    if (order.type == OrderType::PostOnly && crosses) {
+      statuses.emplace_back(makeStatus(order, order.quantity, 0, OrderState::Rejected));
+      return;
+    }
+    if (order.tif == TimeInForce::Fok && !fillable(order, opposite, crosses)) {
+      statuses.emplace_back(makeStatus(order, order.quantity, 0, OrderState::Cancelled));
+      return;
+    }
+    const Quantity remaining =
+        crosses ? sweep(order, opposite, statuses, onRestingClosed) : order.quantity;
+    if (remaining == 0) {
+      return;
+    }
+    if (order.tif != TimeInForce::Gtc || order.type == OrderType::Market) {
+      statuses.emplace_back(makeStatus(order, remaining, 0, OrderState::Cancelled));
+      return;
+    }
+    Order resting = order;
+    resting.quantity = remaining;
+    if (!add(resting)) [[unlikely]] {
+      HFT_LOG_ERROR("Order slab is full, cancelled {}", resting);
+      statuses.emplace_back(makeStatus(order, remaining, 0, OrderState::Cancelled));
+    }
+  }
+
+  /**
+   * @brief Buy stops are sorted descending and sell stops ascending by trigger, so the next
+   * one to fire is always at the back. Equal triggers fire in arrival order
+   */
+  void hold(const Order &order) {
     if (order.action == OrderAction::Buy) {
-      mBids.push_back(order);
-      std::push_heap(mBids.begin(), mBids.end(), compareBids);
+      auto &triggers = mBuyStops.triggers;
+      insertStop(mBuyStops, order,
+                 utils::Simd::lowerBoundDescending(triggers.data(), triggers.size(),
+                                                   order.trigger));
     } else {
-      mAsks.push_back(order);
-      std::push_heap(mAsks.begin(), mAsks.end(), compareAsks);
+      auto &triggers = mSellStops.triggers;
+      insertStop(mSellStops, order,
+                 utils::Simd::lowerBoundAscending(triggers.data(), triggers.size(),
+                                                  order.trigger));
+    }
+  }
+
+  static void insertStop(Stops &stops, const Order &order, size_t position) {
+    stops.triggers.insert(stops.triggers.begin() + position, order.trigger);
+    stops.orders.insert(stops.orders.begin() + position, order);
+  }
+
+  /**
+   * @brief Single compare per side against the last trade price
+   */
+  bool popTriggered(Order &order) {
+    if (mLastPrice == 0) {
+      return false;
+    }
+    if (!mBuyStops.triggers.empty() && mBuyStops.triggers.back() <= mLastPrice) {
+      order = popStop(mBuyStops);
+      return true;
+    }
+    if (!mSellStops.triggers.empty() && mSellStops.triggers.back() >= mLastPrice) {
+      order = popStop(mSellStops);
+      return true;
     }
-    mLastAdded.insert(order.id); // Randomizator
+    return false;
+  }
+
+  static Order popStop(Stops &stops) {
+    Order order = stops.orders.back();
+    stops.triggers.pop_back();
+    stops.orders.pop_back();
+    order.type = order.type == OrderType::Stop ? OrderType::Market : OrderType::Limit;
+    return order;
+  }
+
+  static inline bool crossing(const Order &order, Price best) {
+    return order.action == OrderAction::Buy ? order.price >= best : order.price <= best;
   }
 
-  std::vector<OrderStatus> match() {
-    std::vector<OrderStatus> matches;
-    matches.reserve(10);
+  /**
+   * @brief Best level alone covers most orders, only larger ones sum up level volumes
+   * down to the limit, the orders themselves are walked once by the sweep
+   */
+  bool fillable(const Order &order, const Side &opposite, bool crosses) const {
+    if (!crosses) {
+      return false;
+    }
+    if (mSelfTrade != SelfTradePrevention::Allow) [[unlikely]] {
+      return fillableWithoutSelfTrade(order, opposite);
+    }
+    if (opposite.volumes.back() >= order.quantity) {
+      return true;
+    }
+    return liquidity(order.action, order.price) >= order.quantity;
+  }
 
-    while (!mBids.empty() && !mAsks.empty()) {
-      Order &bestBid = mBids.front();
-      Order &bestAsk = mAsks.front();
-      if (bestBid.price < bestAsk.price) {
-        break;
+  /**
+   * @brief Dry run of the sweep over the orders themselves, own ones never fill.
+   * Only cancel_oldest sweeps past them, other modes stop there, and reserves of icebergs
+   * ahead of an own order are requeued behind it, so only their shown part counts
+   */
+  bool fillableWithoutSelfTrade(const Order &order, const Side &opposite) const {
+    uint64_t available = 0;
+    for (size_t level = opposite.prices.size(); level-- > 0;) {
+      if (!crossing(order, opposite.prices[level])) {
+        return false;
+      }
+      uint64_t reserves = 0;
+      for (OrderIndex index = opposite.queues[level].head; index != INVALID_ORDER_INDEX;
+           index = mSlab->next(index)) {
+        if (mSlab->traderId(index) != order.traderId) {
+          available += mSlab->quantity(index);
+          reserves += mSlab->reserve(index);
+        } else if (mSelfTrade != SelfTradePrevention::CancelOldest) {
+          return available >= order.quantity;
+        }
+        if (available >= order.quantity) {
+          return true;
+        }
+      }
+      available += reserves;
+      if (available >= order.quantity) {
+        return true;
       }
-      auto quantity = std::min(bestBid.quantity, bestAsk.quantity);
-      bestBid.quantity -= quantity;
-      bestAsk.quantity -= quantity;
+    }
+    return false;
+  }
 
-      if (mLastAdded.contains(bestBid.id)) {
-        matches.emplace_back(handleMatch(bestBid, quantity, bestAsk.price));
+  /**
+   * @brief Fills the incoming order from the best opposite level on while it crosses,
+   * returns the unfilled quantity
+   */
+  template <typename Callable>
+  Quantity sweep(const Order &order, Side &opposite, std::vector<OrderStatus> &statuses,
+                 Callable &&onRestingClosed) {
+    Quantity remaining = order.quantity;
+    Quantity prevented = 0;
+    bool preventedLast = false;
+    while (remaining != 0 && !opposite.prices.empty() &&
+           crossing(order, opposite.prices.back())) {
+      const Price price = opposite.prices.back();
+      const OrderIndex index = opposite.queues.back().head;
+      if (mSlab->traderId(index) == order.traderId &&
+          mSelfTrade != SelfTradePrevention::Allow) [[unlikely]] {
+        remaining = preventSelfTrade(order, remaining, prevented, opposite, statuses,
+                                     onRestingClosed);
+        preventedLast = true;
+        continue;
       }
-      if (mLastAdded.contains(bestAsk.id)) {
-        matches.emplace_back(handleMatch(bestAsk, quantity, bestAsk.price));
+      preventedLast = false;
+      Quantity &resting = mSlab->quantity(index);
+      const Quantity quantity = std::min(remaining, resting);
+      resting -= quantity;
+      remaining -= quantity;
+      opposite.volumes.back() -= quantity;
+      mLastPrice = price;
+      statuses.emplace_back(makeStatus(order, quantity, price,
+                                       remaining == 0 ? OrderState::Full : OrderState::Partial));
+      const bool done = resting == 0 && mSlab->reserve(index) == 0;
+      statuses.emplace_back(makeStatus(mSlab->load(index), quantity, price,
+                                       combine(done ? OrderState::Full : OrderState::Partial,
+                                               OrderState::Resting)));
+      if (resting == 0) {
+        exhausted(opposite, onRestingClosed);
+      }
+    }
+    if (prevented != 0) [[unlikely]] {
+      // Closes the order only if prevention took its last quantity, a fill closes it otherwise
+      const bool closes = remaining == 0 && preventedLast;
+      statuses.emplace_back(makeStatus(
+          order, prevented, 0,
+          closes ? OrderState::Cancelled : combine(OrderState::Partial, OrderState::Cancelled)));
+    }
+    return remaining;
+  }
+
+  /**
+   * @brief Head order of the best level ran out of shown quantity, iceberg is replenished
+   * from its reserve, anything else is closed
+   */
+  template <typename Callable>
+  void exhausted(Side &side, Callable &&onRestingClosed) {
+    const OrderIndex index = side.queues.back().head;
+    Quantity &reserve = mSlab->reserve(index);
+    if (reserve != 0) [[unlikely]] {
+      mSlab->quantity(index) = std::min(mSlab->display(index), reserve);
+      reserve -= mSlab->quantity(index);
+      side.hidden -= mSlab->quantity(index);
+      requeue(side);
+    } else {
+      onRestingClosed(mSlab->load(index));
+      popFront(side);
+    }
+  }
+
+  /**
+   * @brief Incoming order met a resting one of the same trader at the head of the best
+   * level, no trade is reported. Resting order gets a Cancelled status for what it lost,
+   * with Partial while it stays in the book. Quantity decremented from the incoming order
+   * adds up in prevented and is reported once by the sweep. Returns the quantity left
+   * to match, zero once the incoming order is cancelled
+   */
+  template <typename Callable>
+  Quantity preventSelfTrade(const Order &order, Quantity remaining, Quantity &prevented,
+                            Side &opposite, std::vector<OrderStatus> &statuses,
+                            Callable &&onRestingClosed) {
+    const OrderIndex index = opposite.queues.back().head;
+    if (mSelfTrade == SelfTradePrevention::Decrement) {
+      Quantity &resting = mSlab->quantity(index);
+      const Quantity quantity = std::min(remaining, resting);
+      resting -= quantity;
+      remaining -= quantity;
+      prevented += quantity;
+      opposite.volumes.back() -= quantity;
+      const bool done = resting == 0 && mSlab->reserve(index) == 0;
+      const OrderState state =
+          done ? OrderState::Cancelled : combine(OrderState::Partial, OrderState::Cancelled);
+      statuses.emplace_back(
+          makeStatus(mSlab->load(index), quantity, 0, combine(state, OrderState::Resting)));
+      if (resting == 0) {
+        exhausted(opposite, onRestingClosed);
       }
+      return remaining;
+    }
+    if (mSelfTrade != SelfTradePrevention::CancelNewest) {
+      const Order resting = mSlab->load(index);
+      opposite.volumes.back() -= mSlab->quantity(index) + mSlab->reserve(index);
+      opposite.hidden -= mSlab->reserve(index);
+      statuses.emplace_back(makeStatus(resting, resting.quantity, 0,
+                                       combine(OrderState::Cancelled, OrderState::Resting)));
+      onRestingClosed(resting);
+      popFront(opposite);
+    }
+    if (mSelfTrade != SelfTradePrevention::CancelOldest) {
+      statuses.emplace_back(makeStatus(order, remaining, 0, OrderState::Cancelled));
+      return 0;
+    }
+    return remaining;
+  }
+
+  /**
+   * @brief Replenished iceberg loses its priority and goes to the back of its level
+   */
+  void requeue(Side &side) {
+    LevelQueue &queue = side.queues.back();
+    const OrderIndex index = queue.head;
+    if (queue.tail == index) {
+      return;
+    }
+    queue.head = mSlab->next(index);
+    mSlab->prev(queue.head) = INVALID_ORDER_INDEX;
+    mSlab->next(queue.tail) = index;
+    mSlab->prev(index) = queue.tail;
+    mSlab->next(index) = INVALID_ORDER_INDEX;
+    queue.tail = index;
+  }
+
+  void link(Side &side, const Order &order, Quantity shown, OrderIndex index,
+            size_t position) {
+    mSlab->next(index) = INVALID_ORDER_INDEX;
+    side.hidden += order.quantity - shown;
+    if (position == side.prices.size() || side.prices[position] != order.price) {
+      mSlab->prev(index) = INVALID_ORDER_INDEX;
+      side.prices.insert(side.prices.begin() + position, order.price);
+      side.volumes.insert(side.volumes.begin() + position, order.quantity);
+      side.queues.insert(side.queues.begin() + position, LevelQueue{index, index});
+      return;
+    }
+    side.volumes[position] += order.quantity;
+    LevelQueue &queue = side.queues[position];
+    mSlab->prev(index) = queue.tail;
+    mSlab->next(queue.tail) = index;
+    queue.tail = index;
+  }
 
-      if (bestBid.quantity == 0) {
-        std::pop_heap(mBids.begin(), mBids.end(), compareBids);
-        mBids.pop_back();
+  void popFront(Side &side) {
+    LevelQueue &queue = side.queues.back();
+    const OrderIndex index = queue.head;
+    queue.head = mSlab->next(index);
+    if (queue.head == INVALID_ORDER_INDEX) {
+      side.prices.pop_back();
+      side.volumes.pop_back();
+      side.queues.pop_back();
+    } else {
+      mSlab->prev(queue.head) = INVALID_ORDER_INDEX;
+    }
+    mSlab->free(index);
+  }
+
+  /**
+   * @brief Shown quantity of the best level. Level volumes count iceberg reserves as well,
+   * so the level is walked only while the side holds any
+   */
+  Quantity shown(const Side &side) const {
+    if (side.hidden == 0) {
+      return side.volumes.back();
+    }
+    Quantity quantity = 0;
+    for (OrderIndex index = side.queues.back().head; index != INVALID_ORDER_INDEX;
+         index = mSlab->next(index)) {
+      quantity += mSlab->quantity(index);
+    }
+    return quantity;
+  }
+
+  std::vector<RestingOrder> collect(const Side &side) const {
+    std::vector<RestingOrder> orders;
+    for (auto queue = side.queues.rbegin(); queue != side.queues.rend(); ++queue) {
+      for (OrderIndex index = queue->head; index != INVALID_ORDER_INDEX;
+           index = mSlab->next(index)) {
+        orders.push_back(RestingOrder{mSlab->load(index), mSlab->quantity(index)});
       }
-      if (bestAsk.quantity == 0) {
-        std::pop_heap(mAsks.begin(), mAsks.end(), compareAsks);
-        mAsks.pop_back();
+    }
+    return orders;
+  }
+
+  void clear() {
+    for (auto *side : {&mBids, &mAsks}) {
+      for (auto &queue : side->queues) {
+        for (OrderIndex index = queue.head; index != INVALID_ORDER_INDEX;) {
+          const OrderIndex next = mSlab->next(index);
+          mSlab->free(index);
+          index = next;
+        }
       }
+      side->prices.clear();
+      side->volumes.clear();
+      side->queues.clear();
+      side->hidden = 0;
     }
-    mLastAdded.clear();
-    return matches;
   }
 
-private:
-  OrderStatus handleMatch(const Order &order, Quantity quantity, Price price) {
+  static constexpr OrderState combine(OrderState state, OrderState flag) {
+    return static_cast<OrderState>(static_cast<uint8_t>(state) | static_cast<uint8_t>(flag));
+  }
+
+  static OrderStatus makeStatus(const Order &order, Quantity quantity, Price price,
+                                OrderState state) {
     OrderStatus status;
     status.id = order.id;
-    status.state = (order.quantity == 0) ? OrderState::Full : OrderState::Partial;
+    status.state = state;
     status.quantity = quantity;
     status.fillPrice = price;
     status.action = order.action;
     status.traderId = order.traderId;
     status.ticker = order.ticker;
-    spdlog::trace([&status] { return utils::toString(status); }());
+    HFT_LOG_TRACE("{}", status);
     return status;
   }
 
 private:
-  std::vector<Order> mBids;
-  std::vector<Order> mAsks;
-  std::set<OrderId> mLastAdded;
+  Slab *mSlab{nullptr};
+  Side mBids;
+  Side mAsks;
+  Stops mBuyStops;
+  Stops mSellStops;
+  Price mLastPrice{0};
+  SelfTradePrevention mSelfTrade{SelfTradePrevention::Allow};
+  std::vector<RestingOrder> mParked;
 };
 
 } // namespace hft::server
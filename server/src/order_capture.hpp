@@ -0,0 +1,245 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-21
+ */
+
+#ifndef HFT_SERVER_ORDERCAPTURE_HPP
+#define HFT_SERVER_ORDERCAPTURE_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "constants.hpp"
+#include "market_types.hpp"
+#include "order_book.hpp"
+#include "template_types.hpp"
+#include "types.hpp"
+#include "utils/tsc.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Inbound order as it was routed, or as received when it never reached a worker,
+ * or a fill the matching produced. Stamped with the TSC on arrival or on match
+ */
+struct CaptureRecord {
+  enum class Type : uint8_t { Order = 1, Fill = 2 };
+  static constexpr size_t PAYLOAD_SIZE = std::max(sizeof(Order), sizeof(OrderStatus));
+
+  uint64_t tsc{0};
+  TraderId session{0};
+  Type type{Type::Order};
+  bool routed{false};
+  uint16_t reserved{0};
+  alignas(8) std::byte payload[PAYLOAD_SIZE];
+
+  Order order() const {
+    Order order;
+    std::memcpy(&order, payload, sizeof(Order));
+    return order;
+  }
+  OrderStatus fill() const {
+    OrderStatus fill;
+    std::memcpy(&fill, payload, sizeof(OrderStatus));
+    return fill;
+  }
+};
+static_assert(sizeof(CaptureRecord) == 48);
+
+/**
+ * @brief Header, then records in the order the writer got them. Orders keep their arrival
+ * order, fills are ordered per worker only. Dropped is filled in when the capture closes
+ */
+struct CaptureHeader {
+  static constexpr uint32_t MAGIC = 0x43544648; // HFTC
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic{MAGIC};
+  uint32_t version{VERSION};
+  double tscPerNs{0};
+  uint64_t dropped{0};
+  SelfTradePrevention selfTrade{SelfTradePrevention::Allow};
+};
+
+struct Capture {
+  CaptureHeader header;
+  std::vector<CaptureRecord> records;
+
+  static Capture read(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      throw std::runtime_error(std::format("Failed to open capture {}", path));
+    }
+    struct stat info{};
+    fstat(fd, &info);
+    const size_t size = info.st_size;
+    if (size < sizeof(CaptureHeader)) {
+      close(fd);
+      throw std::runtime_error(std::format("Invalid capture {}", path));
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error(std::format("Failed to map capture {}", path));
+    }
+    Capture capture;
+    std::memcpy(&capture.header, data, sizeof(CaptureHeader));
+    const bool valid = capture.header.magic == CaptureHeader::MAGIC &&
+                       capture.header.version == CaptureHeader::VERSION;
+    if (valid) {
+      // Tail of a capture cut short is dropped
+      const size_t count = (size - sizeof(CaptureHeader)) / sizeof(CaptureRecord);
+      capture.records.resize(count);
+      std::memcpy(capture.records.data(),
+                  static_cast<const std::byte *>(data) + sizeof(CaptureHeader),
+                  count * sizeof(CaptureRecord));
+    }
+    munmap(data, size);
+    if (!valid) {
+      throw std::runtime_error(std::format("Invalid capture {}", path));
+    }
+    return capture;
+  }
+};
+
+/**
+ * @brief Records inbound order flow and its fills for hft_order_replay. Network thread and
+ * every worker push into their own single producer queue and never wait, the writer thread
+ * drains them into a buffered file. A full queue drops the record and counts it
+ */
+class OrderCapture {
+  static constexpr auto IDLE_SLEEP = std::chrono::milliseconds(1);
+  static constexpr size_t WRITE_CHUNK = 1024;
+
+public:
+  using UPtr = std::unique_ptr<OrderCapture>;
+
+  OrderCapture(const std::string &path, size_t workers, size_t queueSize,
+               SelfTradePrevention selfTrade)
+      : mPath{path}, mOrders{queueSize} {
+    mFile = fopen(path.c_str(), "wb");
+    if (mFile == nullptr) {
+      throw std::runtime_error(std::format("Failed to create capture {}", path));
+    }
+    mHeader.tscPerNs = utils::tscPerNs();
+    mHeader.selfTrade = selfTrade;
+    if (fwrite(&mHeader, sizeof(mHeader), 1, mFile) != 1) {
+      fclose(mFile);
+      throw std::runtime_error(std::format("Failed to write capture {}", path));
+    }
+    for (size_t i = 0; i < workers; ++i) {
+      mFills.emplace_back(std::make_unique<SPSCQueue<CaptureRecord>>(queueSize));
+    }
+    mChunk.resize(WRITE_CHUNK);
+    mThread = std::thread([this]() { run(); });
+  }
+
+  ~OrderCapture() {
+    mRunning.store(false, std::memory_order_release);
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+    mHeader.dropped = mDropped.load(std::memory_order_relaxed);
+    fseek(mFile, 0, SEEK_SET);
+    fwrite(&mHeader, sizeof(mHeader), 1, mFile);
+    fclose(mFile);
+  }
+
+  OrderCapture(const OrderCapture &) = delete;
+  OrderCapture &operator=(const OrderCapture &) = delete;
+
+  /**
+   * @brief Network thread only, tsc is the arrival stamp
+   */
+  inline void pushOrder(uint64_t tsc, TraderId session, const Order &order, bool routed) {
+    push(mOrders, tsc, session, CaptureRecord::Type::Order, routed, order);
+  }
+
+  /**
+   * @brief Owning worker only
+   */
+  inline void pushFill(ThreadId workerId, const OrderStatus &fill) {
+    push(*mFills[workerId], utils::rdtsc(), fill.traderId, CaptureRecord::Type::Fill,
+         true, fill);
+  }
+
+  size_t written() const { return mWritten.load(std::memory_order_relaxed); }
+  size_t dropped() const { return mDropped.load(std::memory_order_relaxed); }
+  const std::string &path() const { return mPath; }
+
+private:
+  template <typename Payload>
+  inline void push(SPSCQueue<CaptureRecord> &queue, uint64_t tsc, TraderId session,
+                   CaptureRecord::Type type, bool routed, const Payload &payload) {
+    CaptureRecord record;
+    record.tsc = tsc;
+    record.session = session;
+    record.type = type;
+    record.routed = routed;
+    std::memset(record.payload, 0, sizeof(record.payload));
+    std::memcpy(record.payload, &payload, sizeof(Payload));
+    if (!queue.push(record)) [[unlikely]] {
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void run() {
+    while (true) {
+      const bool running = mRunning.load(std::memory_order_acquire);
+      size_t drained = drain(mOrders);
+      for (auto &fills : mFills) {
+        drained += drain(*fills);
+      }
+      if (drained != 0) {
+        continue;
+      }
+      if (!running) {
+        break;
+      }
+      fflush(mFile);
+      std::this_thread::sleep_for(IDLE_SLEEP);
+    }
+    fflush(mFile);
+  }
+
+  size_t drain(SPSCQueue<CaptureRecord> &queue) {
+    const size_t count = queue.pop(mChunk.data(), mChunk.size());
+    if (count != 0 && fwrite(mChunk.data(), sizeof(CaptureRecord), count, mFile) != count) {
+      spdlog::error("Failed to write {} records to capture {}", count, mPath);
+    }
+    mWritten.fetch_add(count, std::memory_order_relaxed);
+    return count;
+  }
+
+private:
+  const std::string mPath;
+  FILE *mFile{nullptr};
+  CaptureHeader mHeader;
+
+  SPSCQueue<CaptureRecord> mOrders;
+  std::vector<std::unique_ptr<SPSCQueue<CaptureRecord>>> mFills;
+  std::vector<CaptureRecord> mChunk;
+
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mWritten{0};
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mDropped{0};
+
+  std::atomic_bool mRunning{true};
+  std::thread mThread;
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_ORDERCAPTURE_HPP
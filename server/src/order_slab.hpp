@@ -0,0 +1,220 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-14
+ */
+
+#ifndef HFT_SERVER_ORDERSLAB_HPP
+#define HFT_SERVER_ORDERSLAB_HPP
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "market_types.hpp"
+#include "types.hpp"
+
+namespace hft::server {
+
+using OrderIndex = uint32_t;
+constexpr OrderIndex INVALID_ORDER_INDEX = std::numeric_limits<OrderIndex>::max();
+
+/**
+ * @brief Array mapped and faulted in upfront
+ */
+template <typename Type>
+class MappedArray {
+public:
+  explicit MappedArray(size_t count) : mCount{count} {
+    void *data = mmap(nullptr, bytes(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error(std::format("Failed to allocate order slab of {}", count));
+    }
+    mData = static_cast<Type *>(data);
+  }
+  ~MappedArray() { munmap(mData, bytes()); }
+
+  MappedArray(const MappedArray &) = delete;
+  MappedArray &operator=(const MappedArray &) = delete;
+
+  inline Type &operator[](size_t index) { return mData[index]; }
+  inline const Type &operator[](size_t index) const { return mData[index]; }
+
+private:
+  size_t bytes() const { return std::max<size_t>(mCount, 1) * sizeof(Type); }
+
+  const size_t mCount;
+  Type *mData{nullptr};
+};
+
+/**
+ * @brief Quantity an order shows in its level, the rest of an iceberg is held in reserve
+ */
+inline Quantity displayed(const Order &order) {
+  return order.display == 0 ? order.quantity : std::min(order.display, order.quantity);
+}
+
+/**
+ * @brief Resting order taken out of a slab, quantity is the total and shown is the part of
+ * it currently in the level, so an iceberg keeps a partly consumed peak when it is put back
+ */
+struct RestingOrder {
+  Order order;
+  Quantity shown;
+};
+
+/**
+ * @brief Whole order with its links in one node. Layout the book had before hot
+ * and cold fields were split, kept as the baseline for hft_book_bench
+ */
+class PackedLayout {
+  struct Node {
+    Order order;
+    Quantity reserve;
+    OrderIndex prev;
+    OrderIndex next;
+  };
+
+public:
+  explicit PackedLayout(size_t capacity) : mNodes{capacity} {}
+
+  inline Quantity &quantity(OrderIndex index) { return mNodes[index].order.quantity; }
+  inline Quantity quantity(OrderIndex index) const { return mNodes[index].order.quantity; }
+  inline TraderId traderId(OrderIndex index) const { return mNodes[index].order.traderId; }
+  inline Quantity &reserve(OrderIndex index) { return mNodes[index].reserve; }
+  inline Quantity display(OrderIndex index) const { return mNodes[index].order.display; }
+  inline OrderIndex &next(OrderIndex index) { return mNodes[index].next; }
+  inline OrderIndex next(OrderIndex index) const { return mNodes[index].next; }
+  inline OrderIndex &prev(OrderIndex index) { return mNodes[index].prev; }
+
+  inline void store(OrderIndex index, const Order &order, Quantity shown) {
+    Node &node = mNodes[index];
+    node.order = order;
+    node.order.quantity = shown;
+    node.reserve = order.quantity - shown;
+  }
+  inline Order load(OrderIndex index) const {
+    Order order = mNodes[index].order;
+    order.quantity += mNodes[index].reserve;
+    return order;
+  }
+
+private:
+  MappedArray<Node> mNodes;
+};
+
+/**
+ * @brief Structure of arrays, matching walks only quantity, next link and the owner needed
+ * for self trade prevention packed in 12 bytes, so a cache line covers 5 queued orders.
+ * Price lives in the level, metadata needed only to report a fill or to replenish an
+ * iceberg is kept aside, backward links are touched only when unlinking
+ */
+class SplitLayout {
+  struct HotNode {
+    Quantity quantity;
+    OrderIndex next;
+    TraderId traderId;
+  };
+  struct ColdNode {
+    OrderId id;
+    Ticker ticker;
+    Price price;
+    Quantity display;
+    Quantity reserve;
+    OrderAction action;
+  };
+  static_assert(sizeof(HotNode) == 12);
+
+public:
+  explicit SplitLayout(size_t capacity) : mHot{capacity}, mPrev{capacity}, mCold{capacity} {}
+
+  inline Quantity &quantity(OrderIndex index) { return mHot[index].quantity; }
+  inline Quantity quantity(OrderIndex index) const { return mHot[index].quantity; }
+  inline TraderId traderId(OrderIndex index) const { return mHot[index].traderId; }
+  inline Quantity &reserve(OrderIndex index) { return mCold[index].reserve; }
+  inline Quantity display(OrderIndex index) const { return mCold[index].display; }
+  inline OrderIndex &next(OrderIndex index) { return mHot[index].next; }
+  inline OrderIndex next(OrderIndex index) const { return mHot[index].next; }
+  inline OrderIndex &prev(OrderIndex index) { return mPrev[index]; }
+
+  inline void store(OrderIndex index, const Order &order, Quantity shown) {
+    mHot[index].quantity = shown;
+    mHot[index].traderId = order.traderId;
+    mCold[index] = ColdNode{order.id, order.ticker, order.price, order.display,
+                            order.quantity - shown, order.action};
+  }
+  inline Order load(OrderIndex index) const {
+    const HotNode &hot = mHot[index];
+    const ColdNode &cold = mCold[index];
+    Order order{hot.traderId, cold.id, cold.ticker, hot.quantity + cold.reserve, cold.price,
+                cold.action};
+    order.display = cold.display;
+    return order;
+  }
+
+private:
+  MappedArray<HotNode> mHot;
+  MappedArray<OrderIndex> mPrev;
+  MappedArray<ColdNode> mCold;
+};
+
+/**
+ * @brief Fixed capacity pool of resting orders owned by a single worker
+ * Memory is mapped and faulted in at startup, nodes are taken from the free list or the
+ * untouched tail and returned to the free list, so the matching path never allocates
+ */
+template <typename Layout>
+class BasicOrderSlab : public Layout {
+public:
+  using UPtr = std::unique_ptr<BasicOrderSlab>;
+
+  explicit BasicOrderSlab(size_t capacity)
+      : Layout{std::min<size_t>(capacity, INVALID_ORDER_INDEX)},
+        mCapacity{std::min<size_t>(capacity, INVALID_ORDER_INDEX)} {}
+
+  BasicOrderSlab(const BasicOrderSlab &) = delete;
+  BasicOrderSlab &operator=(const BasicOrderSlab &) = delete;
+
+  /**
+   * @brief Returns INVALID_ORDER_INDEX when the slab is full
+   */
+  inline OrderIndex allocate() {
+    OrderIndex index = mFreeHead;
+    if (index != INVALID_ORDER_INDEX) {
+      mFreeHead = this->next(index);
+    } else if (mUntouched < mCapacity) {
+      index = mUntouched++;
+    } else {
+      return INVALID_ORDER_INDEX;
+    }
+    mOccupied.store(mOccupied.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return index;
+  }
+
+  inline void free(OrderIndex index) {
+    this->next(index) = mFreeHead;
+    mFreeHead = index;
+    mOccupied.store(mOccupied.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return mCapacity; }
+  size_t occupancy() const { return mOccupied.load(std::memory_order_relaxed); }
+
+private:
+  const size_t mCapacity;
+  OrderIndex mFreeHead{INVALID_ORDER_INDEX};
+  OrderIndex mUntouched{0};
+  std::atomic_size_t mOccupied{0};
+};
+
+using OrderSlab = BasicOrderSlab<SplitLayout>;
+using PackedOrderSlab = BasicOrderSlab<PackedLayout>;
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_ORDERSLAB_HPP
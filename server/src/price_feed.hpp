@@ -0,0 +1,180 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-18
+ */
+
+#ifndef HFT_SERVER_PRICEFEED_HPP
+#define HFT_SERVER_PRICEFEED_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "boost_types.hpp"
+#include "market_types.hpp"
+#include "network/async_socket.hpp"
+#include "network_types.hpp"
+#include "ticker_index.hpp"
+#include "types.hpp"
+#include "utils/seqlock.hpp"
+#include "utils/utils.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Latest quote of every ticker with a dirty bit per channel. Workers update quotes
+ * in place, every channel sends only tickers changed since its own last tick. Repeated
+ * updates of a ticker between ticks collapse into one message, so a slow channel gets
+ * conflated prices instead of a backlog
+ */
+class PriceFeed {
+  using FeedSocket = AsyncSocket<UdpSocket, TickerPrice>;
+
+  struct alignas(32) Slot {
+    utils::SeqLock<TickerPrice> quote;
+  };
+
+  /**
+   * @brief Subscriber class, all subscribers of a class listen on its port
+   */
+  struct Channel {
+    Channel(IoContext &ctx, Port port, size_t rateUs, size_t words)
+        : socket{utils::createUdpSocket(ctx), UdpEndpoint{Ip::address_v4::broadcast(), port}},
+          timer{ctx}, port{port}, rateUs{rateUs}, dirty(words) {}
+
+    FeedSocket socket;
+    SteadyTimer timer;
+    const Port port;
+    const size_t rateUs;
+    std::vector<std::atomic_uint64_t> dirty;
+    size_t published{0};
+    size_t ticks{0};
+  };
+
+public:
+  struct Stats {
+    Port port;
+    size_t rateUs;
+    size_t ticks;
+    size_t published;
+  };
+
+  PriceFeed(IoContext &ctx, const TickerIndex &index, const std::vector<TickerPrice> &prices)
+      : mCtx{ctx}, mSlots(index.size()) {
+    for (TickerId tickerId = 0; tickerId < index.size(); ++tickerId) {
+      mSlots[tickerId].quote.store(TickerPrice{index.ticker(tickerId), 0});
+    }
+    for (auto &tickerPrice : prices) {
+      TickerId tickerId = index.find(tickerPrice.ticker);
+      if (tickerId != INVALID_TICKER_ID) {
+        mSlots[tickerId].quote.store(tickerPrice);
+      }
+    }
+    mPending.reserve(index.size());
+  }
+
+  /**
+   * @brief Channels are added before workers start. Every ticker starts dirty,
+   * so the first tick of a channel sends a full picture
+   */
+  void addChannel(Port port, size_t rateUs) {
+    const size_t words = (mSlots.size() + 63) / 64;
+    auto &channel = *mChannels.emplace_back(
+        std::make_unique<Channel>(mCtx, port, std::max<size_t>(rateUs, 1), words));
+    for (size_t tickerId = 0; tickerId < mSlots.size(); ++tickerId) {
+      channel.dirty[tickerId / 64].fetch_or(1ULL << (tickerId % 64), std::memory_order_relaxed);
+    }
+    schedule(channel);
+  }
+
+  /**
+   * @brief Called by the owner of the ticker after every order, unchanged quotes are
+   * dropped here. Zero price means no trade yet and keeps the reference one
+   */
+  inline void update(TickerId tickerId, const TickerPrice &quote) {
+    auto &slot = mSlots[tickerId].quote;
+    const TickerPrice current = slot.load();
+    TickerPrice next = quote;
+    next.ticker = current.ticker;
+    if (next.price == 0) {
+      next.price = current.price;
+    }
+    if (std::memcmp(&next, &current, sizeof(TickerPrice)) == 0) {
+      return;
+    }
+    slot.store(next);
+    markDirty(tickerId);
+  }
+
+  /**
+   * @brief Moves only the last price, callable from any thread
+   */
+  void updatePrice(TickerId tickerId, Price price) {
+    mSlots[tickerId].quote.modify([price](TickerPrice &quote) { quote.price = price; });
+    markDirty(tickerId);
+  }
+
+  void stop() {
+    for (auto &channel : mChannels) {
+      channel->timer.cancel();
+    }
+  }
+
+  std::vector<Stats> stats() const {
+    std::vector<Stats> result;
+    for (auto &channel : mChannels) {
+      result.push_back({channel->port, channel->rateUs, channel->ticks, channel->published});
+    }
+    return result;
+  }
+
+private:
+  inline void markDirty(TickerId tickerId) {
+    const uint64_t bit = 1ULL << (tickerId % 64);
+    for (auto &channel : mChannels) {
+      channel->dirty[tickerId / 64].fetch_or(bit, std::memory_order_release);
+    }
+  }
+
+  void schedule(Channel &channel) {
+    channel.timer.expires_after(Microseconds(channel.rateUs));
+    channel.timer.async_wait([this, &channel](BoostErrorRef ec) {
+      if (ec) {
+        return;
+      }
+      publish(channel);
+      schedule(channel);
+    });
+  }
+
+  void publish(Channel &channel) {
+    mPending.clear();
+    for (size_t word = 0; word < channel.dirty.size(); ++word) {
+      uint64_t bits = channel.dirty[word].exchange(0, std::memory_order_acquire);
+      while (bits != 0) {
+        const TickerId tickerId = word * 64 + std::countr_zero(bits);
+        bits &= bits - 1;
+        mPending.push_back(mSlots[tickerId].quote.load());
+      }
+    }
+    ++channel.ticks;
+    if (mPending.empty()) {
+      return;
+    }
+    channel.published += mPending.size();
+    channel.socket.asyncWrite(Span<TickerPrice>(mPending));
+  }
+
+private:
+  IoContext &mCtx;
+
+  std::vector<Slot> mSlots;
+  std::vector<std::unique_ptr<Channel>> mChannels;
+  std::vector<TickerPrice> mPending;
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_PRICEFEED_HPP
@@ -0,0 +1,195 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-08
+ */
+
+#ifndef HFT_SERVER_RISKCHECKER_HPP
+#define HFT_SERVER_RISKCHECKER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+#include "config/config.hpp"
+#include "constants.hpp"
+#include "market_types.hpp"
+#include "types.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Pre-trade checks run on the network thread before an order is routed to a worker
+ * All limits are evaluated unconditionally and combined into a single verdict, zero in the
+ * config disables a limit by turning it into the widest possible one
+ */
+class RiskChecker {
+  static constexpr uint64_t NS_PER_TOKEN = 1000000000;
+
+  /**
+   * @brief Token bucket is in fixed point, one order costs NS_PER_TOKEN and every
+   * nanosecond refills the order rate, so no division on the hot path.
+   * Open orders are released by workers, the rest is touched by the network thread only
+   */
+  struct alignas(CACHE_LINE_SIZE) SessionState {
+    uint64_t tokens{0};
+    uint64_t lastRefillNs{0};
+    std::atomic<uint32_t> openOrders{0};
+  };
+
+  struct PriceBand {
+    Price low{0};
+    Price high{std::numeric_limits<Price>::max()};
+  };
+
+public:
+  RiskChecker(size_t sessions, size_t tickers)
+      : mSessions(sessions), mBands(tickers), mReferences(tickers, 0), mTradePrices(tickers),
+        mMaxQuantity{orMax<Quantity>(Config::cfg.maxOrderQuantity)},
+        mMaxNotional{orMax<uint64_t>(Config::cfg.maxOrderNotional)},
+        mMaxOpenOrders{orMax<uint32_t>(Config::cfg.maxOpenOrders)},
+        mCollarPct{Config::cfg.priceCollarPct},
+        mProtectionPct{Config::cfg.marketProtectionPct}, mRefillRate{Config::cfg.orderRateLimit},
+        mOrderCost{mRefillRate == 0 ? 0 : NS_PER_TOKEN},
+        mBucketSize{mOrderCost * std::max<uint64_t>(Config::cfg.orderBurst, 1)},
+        mRefillCapNs{mRefillRate == 0 ? 0 : mBucketSize / mRefillRate} {
+    for (auto &session : mSessions) {
+      session.tokens = mBucketSize;
+    }
+  }
+
+  inline bool check(const Order &order, TickerId tickerId, uint64_t nowNs) {
+    auto &session = mSessions[order.traderId];
+    const uint64_t elapsed = std::min(nowNs - session.lastRefillNs, mRefillCapNs);
+    session.tokens = std::min(session.tokens + elapsed * mRefillRate, mBucketSize);
+    session.lastRefillNs = nowNs;
+
+    // Unsigned wrap folds zero quantity and price outside the band into one compare each
+    const PriceBand band = mBands[tickerId];
+    const bool throttled = session.tokens < mOrderCost;
+    const bool rejected =
+        throttled | (order.quantity - 1 >= mMaxQuantity) |
+        (static_cast<uint64_t>(order.quantity) * order.price > mMaxNotional) |
+        (order.price - band.low > band.high - band.low) |
+        (session.openOrders.load(std::memory_order_relaxed) >= mMaxOpenOrders);
+
+    session.tokens -= throttled ? 0 : mOrderCost;
+    if (rejected) {
+      return false;
+    }
+    session.openOrders.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Called from workers once the order is fully filled, cancelled or rejected
+   */
+  inline void onClosed(TraderId traderId) {
+    mSessions[traderId].openOrders.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Accounts orders that skipped the checks, like ones replayed from the journal
+   */
+  inline void onRecovered(TraderId traderId) {
+    mSessions[traderId].openOrders.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Fresh token bucket for a reused session slot, open orders are zero by then
+   */
+  void resetSession(TraderId traderId) {
+    mSessions[traderId].tokens = mBucketSize;
+    mSessions[traderId].lastRefillNs = 0;
+  }
+
+  /**
+   * @brief Called from workers with the last trade price of a ticker they own, zero means
+   * no trade yet. Stored only when it moves, so the network thread reads a clean line
+   */
+  inline void onTrade(TickerId tickerId, Price price) {
+    auto &last = mTradePrices[tickerId];
+    if (price != 0 && last.load(std::memory_order_relaxed) != price) {
+      last.store(price, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Moves the collar of a ticker to its last trade price, called on the network
+   * thread before the ticker is checked
+   */
+  inline void refreshReference(TickerId tickerId) {
+    const Price price = mTradePrices[tickerId].load(std::memory_order_relaxed);
+    if (price != 0 && price != mReferences[tickerId]) [[unlikely]] {
+      setReferencePrice(tickerId, price);
+    }
+  }
+
+  /**
+   * @brief Collar is centered on the reference price, the database one until the ticker
+   * trades and the last trade price after that. Until there is one any price passes
+   */
+  void setReferencePrice(TickerId tickerId, Price price) {
+    mReferences[tickerId] = price;
+    if (mCollarPct == 0) {
+      return;
+    }
+    const uint64_t width = static_cast<uint64_t>(price) * mCollarPct / 100;
+    mBands[tickerId].low = price - std::min<uint64_t>(width, price);
+    mBands[tickerId].high =
+        std::min<uint64_t>(price + width, std::numeric_limits<Price>::max());
+  }
+
+  /**
+   * @brief Worst price a market order may trade at, it is converted into an Ioc limit order
+   * at this price. Zero if there is no reference price yet, such order can't be protected
+   */
+  Price marketLimit(TickerId tickerId, OrderAction action) const {
+    return protectionLimit(mReferences[tickerId], action);
+  }
+
+  Price protectionLimit(Price reference, OrderAction action) const {
+    if (mProtectionPct == 0) {
+      return action == OrderAction::Buy ? std::numeric_limits<Price>::max() : 1;
+    }
+    if (reference == 0) {
+      return 0;
+    }
+    const uint64_t width = static_cast<uint64_t>(reference) * mProtectionPct / 100;
+    if (action == OrderAction::Buy) {
+      return std::min<uint64_t>(reference + width, std::numeric_limits<Price>::max());
+    }
+    return reference - std::min<uint64_t>(width, reference - 1);
+  }
+
+  uint32_t openOrders(TraderId traderId) const {
+    return mSessions[traderId].openOrders.load(std::memory_order_relaxed);
+  }
+
+private:
+  template <typename Type, typename Value>
+  static constexpr Type orMax(Value value) {
+    return value == 0 ? std::numeric_limits<Type>::max() : static_cast<Type>(value);
+  }
+
+private:
+  std::vector<SessionState> mSessions;
+  std::vector<PriceBand> mBands;
+  std::vector<Price> mReferences;
+  std::vector<std::atomic<Price>> mTradePrices; // Written by workers
+
+  const Quantity mMaxQuantity;
+  const uint64_t mMaxNotional;
+  const uint32_t mMaxOpenOrders;
+  const uint32_t mCollarPct;
+  const uint32_t mProtectionPct;
+
+  const uint64_t mRefillRate;
+  const uint64_t mOrderCost;
+  const uint64_t mBucketSize;
+  const uint64_t mRefillCapNs;
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_RISKCHECKER_HPP
@@ -7,6 +7,7 @@
 #define HFT_SERVER_SERVER_HPP
 
 #include <fcntl.h>
+#include <deque>
 #include <format>
 #include <iostream>
 #include <memory>
@@ -15,46 +16,121 @@
 #include "boost_types.hpp"
 #include "comparators.hpp"
 #include "config/config.hpp"
-#include "db/postgres_adapter.hpp"
+#include "db/ticker_provider.hpp"
+#include "db/trade_persister.hpp"
+#include "journal.hpp"
 #include "market_types.hpp"
 #include "network/async_socket.hpp"
 #include "network_types.hpp"
 #include "order_book.hpp"
+#include "order_capture.hpp"
+#include "pool/buffer_pool.hpp"
+#include "price_feed.hpp"
+#include "risk_checker.hpp"
+#include "rtt_tracker.hpp"
+#include "snapshot.hpp"
 #include "template_types.hpp"
+#include "ticker_index.hpp"
+#include "ticker_router.hpp"
 #include "types.hpp"
+#include "utils/rng.hpp"
+#include "utils/tsc.hpp"
 #include "utils/utils.hpp"
+#include "worker_inbox.hpp"
 
 namespace hft::server {
 
+struct RiskHop {
+  static constexpr auto NAME = "Risk";
+};
+using RiskTracker = LatencyTracker<RiskHop, 100, 500>;
+
 class Server {
-  using ServerTcpSocket = AsyncSocket<TcpSocket, Order>;
-  using ServerUdpSocket = AsyncSocket<UdpSocket, TickerPrice>;
-  using OrderBook = FlatOrderBook;
+  static constexpr size_t MAX_MIGRATIONS = 8;
+  static constexpr size_t SNAPSHOT_CHUNK = 64;
+
+  using IngressSocket = AsyncSocket<TcpSocket, Order>;
+  using EgressSocket = AsyncSocket<TcpSocket, LoginRequest>;
+  using OrderBook = FlatOrderBook<OrderSlab>;
 
+  /**
+   * @brief Slot in the flat session table, index is the session id stamped into orders.
+   * State is touched by the network thread only. Workers write statuses only while open is
+   * set, it is set once egress is bound and cleared before the sockets go away.
+   * Retired slot still has resting orders, of a closed session or recovered ones
+   */
   struct Session {
-    ServerTcpSocket::UPtr ingress;
-    ServerTcpSocket::UPtr egress;
+    enum class State : uint8_t { Free, Connected, LoggedIn, Closing, Retired };
+
+    IngressSocket::UPtr ingress;
+    EgressSocket::UPtr egress;
+    SessionToken token{0};
+    State state{State::Free};
+    std::atomic_bool open{false};
+  };
+
+  /**
+   * @brief Book with its current owner worker
+   */
+  struct BookEntry {
+    OrderBook book;
+    std::atomic<ThreadId> owner{0};
+    uint64_t sequence{0};
+  };
+
+  /**
+   * @brief Scratch of one worker drain: orders popped from its inbox and statuses collected
+   * per session, so every session gets one write per batch
+   */
+  struct WorkerBatch {
+    std::vector<WorkerInbox::Item> orders;
+    std::vector<std::vector<OrderStatus>> outbox;
+    std::vector<TraderId> touched;
+    // Orders of tickers migrating to this worker, held until the old owner hands them over.
+    // Only this worker touches them, the old owner never looks here
+    std::unordered_map<TickerId, std::vector<Order>> deferred;
+  };
+
+  /**
+   * @brief Books collected for one snapshot. Every worker copies the books it owns in small
+   * chunks between orders, a book migrating in between is taken by whoever sees it first
+   */
+  struct SnapshotRound {
+    explicit SnapshotRound(size_t books, size_t workers)
+        : books(books), taken(books), pending{workers} {}
+
+    std::vector<BookSnapshot> books;
+    std::vector<std::atomic_bool> taken;
+    std::atomic_size_t pending;
   };
 
 public:
   Server()
-      : mIngressAcceptor{mCtx}, mEgressAcceptor{mCtx},
-        mPricesSocket{utils::createUdpSocket(mCtx),
-                      UdpEndpoint{Ip::address_v4::broadcast(), Config::cfg.portUdp}},
-        mInputTimer{mCtx}, mStatsTimer{mCtx}, mPriceTimer{mCtx},
-        mStatsRateS{Config::cfg.monitorRateS}, mPriceRateUs{Config::cfg.priceFeedRateUs} {
+      : mIngressAcceptor{mCtx}, mEgressAcceptor{mCtx}, mInputTimer{mCtx}, mStatsTimer{mCtx},
+        mPriceTimer{mCtx}, mRebalanceTimer{mCtx}, mSnapshotTimer{mCtx},
+        mStatsRateS{Config::cfg.monitorRateS}, mPriceRateUs{Config::cfg.priceFeedRateUs},
+        mRebalanceRateS{Config::cfg.rebalanceRateS} {
     if (Config::cfg.coreIds.size() == 0 || Config::cfg.coreIds.size() > 10) {
       throw std::runtime_error("Invalid cores configuration");
     }
     fcntl(STDIN_FILENO, F_SETFL, O_NONBLOCK);
     std::cout << std::unitbuf;
 
+    mSessions = std::vector<Session>(Config::cfg.maxSessions);
+    for (size_t id = mSessions.size(); id != 0; --id) {
+      mFreeSessions.push_back(id - 1);
+    }
     initMarketData();
+    startPersistence();
+    startJournal();
+    startCapture();
     startWorkers();
     startIngress();
     startEgress();
     scheduleInputTimer();
     scheduleStatsTimer();
+    scheduleRebalanceTimer();
+    startSnapshots();
   }
   ~Server() {
     for (auto &thread : mWorkerThreads) {
@@ -62,6 +138,14 @@ public:
         thread.join();
       }
     }
+    mJournalRunning.store(false, std::memory_order_release);
+    if (mJournalThread.joinable()) {
+      mJournalThread.join();
+    }
+    mSnapshotGuard.reset();
+    if (mSnapshotThread.joinable()) {
+      mSnapshotThread.join();
+    }
   }
 
   void start() {
@@ -79,19 +163,34 @@ private:
     acceptIngress();
   }
 
+  /**
+   * @brief Every ingress connection takes a free session slot, slot index and a random
+   * token are sent back to the trader who then presents them on the egress connection
+   */
   void acceptIngress() {
     mIngressAcceptor.async_accept([this](BoostErrorRef ec, TcpSocket socket) {
-      socket.set_option(TcpSocket::protocol_type::no_delay(true));
       if (ec) {
         spdlog::error("Failed to accept connection {}", ec.message());
         return;
       }
-      auto traderId = utils::getTraderId(socket);
-      Logger::monitorLogger->info("{} connected", traderId);
-      mSessions[traderId].ingress = std::make_unique<ServerTcpSocket>(
+      const TraderId traderId = acquireSession();
+      if (traderId == mSessions.size()) {
+        Logger::monitorLogger->error("Session limit {} reached", mSessions.size());
+        acceptIngress();
+        return;
+      }
+      socket.set_option(TcpSocket::protocol_type::no_delay(true));
+      Logger::monitorLogger->info("{} ingress connected", traderId);
+      auto &session = mSessions[traderId];
+      session.state = Session::State::Connected;
+      session.token = utils::RNG::rng<SessionToken>(std::numeric_limits<SessionToken>::max());
+      session.ingress = std::make_unique<IngressSocket>(
           std::move(socket), traderId,
           [this, traderId](const Order &order) { dispatchOrder(traderId, order); });
-      mSessions[traderId].ingress->asyncRead();
+      session.ingress->setCloseHandler([this, traderId]() { closeSession(traderId); });
+      LoginResponse response{traderId, session.token};
+      session.ingress->asyncWrite(Span<LoginResponse>{&response, 1});
+      session.ingress->asyncRead();
       acceptIngress();
     });
   }
@@ -111,18 +210,127 @@ private:
         return;
       }
       socket.set_option(TcpSocket::protocol_type::no_delay(true));
-      auto id = utils::getTraderId(socket);
-      Logger::monitorLogger->info("{} connected", id);
-      mSessions[id].egress =
-          std::make_unique<ServerTcpSocket>(std::move(socket), id, [](const Order &) {});
+      size_t pendingId = mNextPendingId++;
+      auto &egress = mPendingEgress[pendingId];
+      egress = std::make_unique<EgressSocket>(
+          std::move(socket), 0,
+          [this, pendingId](const LoginRequest &request) { onLogin(pendingId, request); });
+      egress->asyncRead();
       acceptEgress();
     });
   }
 
+  void onLogin(size_t pendingId, const LoginRequest &request) {
+    auto pending = mPendingEgress.find(pendingId);
+    if (pending == mPendingEgress.end()) {
+      spdlog::error("Repeated login {} on egress socket", request.traderId);
+      return;
+    }
+    if (request.traderId >= mSessions.size() ||
+        mSessions[request.traderId].state != Session::State::Connected ||
+        mSessions[request.traderId].token != request.token) {
+      Logger::monitorLogger->error("Invalid login {}", request.traderId);
+      // Called from the socket own read handler, so drop it afterwards
+      boost::asio::post(mCtx, [this, pendingId]() { mPendingEgress.erase(pendingId); });
+      return;
+    }
+    const TraderId traderId = request.traderId;
+    auto &session = mSessions[traderId];
+    session.egress = std::move(pending->second);
+    session.egress->setCloseHandler([this, traderId]() { closeSession(traderId); });
+    session.state = Session::State::LoggedIn;
+    session.open.store(true, std::memory_order_release);
+    mPendingEgress.erase(pending);
+    Logger::monitorLogger->info("{} egress connected", traderId);
+  }
+
+  /**
+   * @brief Free slot, or a retired one whose resting orders have all closed since.
+   * Returns the table size if there is none
+   */
+  TraderId acquireSession() {
+    if (mFreeSessions.empty()) {
+      std::erase_if(mRetiredSessions, [this](TraderId traderId) {
+        if (mRisk->openOrders(traderId) != 0) {
+          return false;
+        }
+        mSessions[traderId].state = Session::State::Free;
+        mFreeSessions.push_back(traderId);
+        return true;
+      });
+    }
+    if (mFreeSessions.empty()) {
+      return mSessions.size();
+    }
+    const TraderId traderId = mFreeSessions.back();
+    mFreeSessions.pop_back();
+    mRisk->resetSession(traderId);
+    return traderId;
+  }
+
+  /**
+   * @brief Either socket of a session going down ends it. Workers stop writing to it first,
+   * sockets are closed once every worker has drained what it had in flight
+   */
+  void closeSession(TraderId traderId) {
+    auto &session = mSessions[traderId];
+    if (session.state != Session::State::Connected &&
+        session.state != Session::State::LoggedIn) {
+      return;
+    }
+    Logger::monitorLogger->info("{} disconnected", traderId);
+    session.state = Session::State::Closing;
+    session.open.store(false, std::memory_order_release);
+    session.token = 0;
+    auto pending = std::make_shared<std::atomic_size_t>(mWorkerContexts.size());
+    for (auto &ctx : mWorkerContexts) {
+      boost::asio::post(*ctx, [this, traderId, pending]() {
+        if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          boost::asio::post(mCtx, [this, traderId]() { releaseSession(traderId); });
+        }
+      });
+    }
+  }
+
+  /**
+   * @brief Cancelled reads complete before the posted reset, so no handler outlives its
+   * socket. Resting orders of the session keep the slot retired until they close,
+   * a new trader never gets statuses of them
+   */
+  void releaseSession(TraderId traderId) {
+    auto &session = mSessions[traderId];
+    if (session.ingress != nullptr) {
+      session.ingress->close();
+    }
+    if (session.egress != nullptr) {
+      session.egress->close();
+    }
+    boost::asio::post(mCtx, [this, traderId]() {
+      auto &session = mSessions[traderId];
+      session.ingress.reset();
+      session.egress.reset();
+      if (mRisk->openOrders(traderId) == 0) {
+        session.state = Session::State::Free;
+        mFreeSessions.push_back(traderId);
+      } else {
+        session.state = Session::State::Retired;
+        mRetiredSessions.push_back(traderId);
+      }
+    });
+  }
+
   void startWorkers() {
     mWorkerContexts.reserve(Config::cfg.coreIds.size());
     mWorkerGuards.reserve(Config::cfg.coreIds.size());
+    mBatchSize = std::max<size_t>(Config::cfg.matchBatchSize, 1);
+    mBatches.resize(Config::cfg.coreIds.size());
+    for (auto &batch : mBatches) {
+      batch.orders.resize(mBatchSize);
+      // Extra slot for recovered orders of traders beyond the session table
+      batch.outbox.resize(mSessions.size() + 1);
+    }
     for (int i = 0; i < Config::cfg.coreIds.size(); ++i) {
+      mInboxes.emplace_back(std::make_unique<WorkerInbox>(Config::cfg.workerQueueSize));
       mWorkerContexts.emplace_back(std::make_unique<IoContext>());
       mWorkerGuards.emplace_back(
           std::make_unique<ContextGuard>(boost::asio::make_work_guard(*mWorkerContexts.back())));
@@ -138,30 +346,626 @@ private:
     }
   }
 
-  ThreadId getWorkerId(const Ticker &ticker) {
-    return utils::getTickerHash(ticker) % Config::cfg.coreIds.size();
+  /**
+   * @brief Captured orders are stamped on arrival and recorded as they were routed,
+   * so a replay feeds the workers the same orders
+   */
+  void dispatchOrder(TraderId traderId, const Order &order) {
+    const uint64_t arrival = mCapture != nullptr ? utils::rdtsc() : 0;
+    Order routed = order;
+    const bool accepted = routeOrder(traderId, routed);
+    if (mCapture != nullptr) {
+      mCapture->pushOrder(arrival, traderId, routed, accepted);
+    }
   }
 
-  void dispatchOrder(TraderId traderId, const Order &order) {
-    spdlog::debug([&order] { return utils::toString(order); }());
+  /**
+   * @brief Market and stop orders get their protection price set in place.
+   * Returns true once the order is queued to its worker
+   */
+  bool routeOrder(TraderId traderId, Order &order) {
+    HFT_LOG_DEBUG("{}", order);
+    if (mSessions[traderId].state != Session::State::LoggedIn) {
+      spdlog::error("Order from session {} before login", traderId);
+      return false;
+    }
+    TickerId tickerId = mTickerIndex.find(order.ticker);
+    if (tickerId == INVALID_TICKER_ID) {
+      spdlog::error("Unknown ticker {}", utils::toStrView(order.ticker));
+      return false;
+    }
     mOrdersTotal.fetch_add(1, std::memory_order_relaxed);
+    mRisk->refreshReference(tickerId);
 
-    ThreadId workerId = getWorkerId(order.ticker);
-    boost::asio::post(*mWorkerContexts[workerId], [this, order, traderId]() {
-      size_t tickerId = utils::getTickerHash(order.ticker);
-      mOrderBooks[tickerId].add(order);
-      auto matches = mOrderBooks[tickerId].match();
-      mSessions[traderId].egress->asyncWrite(Span<OrderStatus>(matches));
-      mOrdersClosed.fetch_add(matches.size(), std::memory_order_relaxed);
+    // Market orders go further as limit orders at the protection price, checked as such,
+    // stop market orders are protected around their trigger instead
+    bool priced = true;
+    switch (order.type) {
+    case OrderType::Market:
+      order.price = mRisk->marketLimit(tickerId, order.action);
+      priced = order.price != 0;
+      break;
+    case OrderType::Stop:
+      order.price = mRisk->protectionLimit(order.trigger, order.action);
+      priced = order.price != 0 && order.trigger != 0;
+      break;
+    case OrderType::StopLimit:
+      priced = order.trigger != 0;
+      break;
+    default:
+      break;
+    }
+    if (!priced) {
+      rejectOrder(order);
+      return false;
+    }
+    const uint64_t riskStart = RiskTracker::now();
+    const bool passed = mRisk->check(order, tickerId, riskStart);
+    RiskTracker::logSince(riskStart);
+    if (!passed) {
+      rejectOrder(order);
+      return false;
+    }
+    mRouter->count(tickerId);
+
+    ThreadId workerId = mRouter->route(tickerId);
+    auto &inbox = *mInboxes[workerId];
+    if (!inbox.push(tickerId, order)) [[unlikely]] {
+      Logger::monitorLogger->error("Worker {} queue is full", workerId);
+      mRisk->onClosed(order.traderId);
+      rejectOrder(order);
+      return false;
+    }
+    if (inbox.schedule()) {
+      boost::asio::post(*mWorkerContexts[workerId], [this, workerId]() { drain(workerId); });
+    }
+    return true;
+  }
+
+  void rejectOrder(const Order &order) {
+    mOrdersRejected.fetch_add(1, std::memory_order_relaxed);
+    OrderStatus status;
+    status.traderId = order.traderId;
+    status.id = order.id;
+    status.ticker = order.ticker;
+    status.quantity = order.quantity;
+    status.fillPrice = 0;
+    status.state = OrderState::Rejected;
+    status.action = order.action;
+    mSessions[order.traderId].egress->asyncWrite(Span<OrderStatus>{&status, 1});
+  }
+
+  /**
+   * @brief Takes whatever is queued up to the batch size, so a lone order goes through
+   * right away and a backlog is matched in batches. Worker yields between batches
+   */
+  void drain(ThreadId workerId) {
+    if (drainBatch(workerId, mBatchSize) == mBatchSize || mInboxes[workerId]->release()) {
+      boost::asio::post(*mWorkerContexts[workerId], [this, workerId]() { drain(workerId); });
+    }
+  }
+
+  /**
+   * @brief Orders of a batch are grouped by ticker keeping their arrival order, so each book
+   * is matched back to back while it is in cache. Statuses are flushed once per session
+   */
+  size_t drainBatch(ThreadId workerId, size_t limit) {
+    auto &batch = mBatches[workerId];
+    const size_t count = mInboxes[workerId]->pop(batch.orders.data(), limit);
+    const auto end = batch.orders.begin() + count;
+    std::stable_sort(batch.orders.begin(), end,
+                     [](const WorkerInbox::Item &left, const WorkerInbox::Item &right) {
+                       return left.tickerId < right.tickerId;
+                     });
+    for (auto it = batch.orders.begin(); it != end; ++it) {
+      processOrder(workerId, it->tickerId, it->order);
+    }
+    flushStatuses(workerId);
+    return count;
+  }
+
+  void flushStatuses(ThreadId workerId) {
+    auto &batch = mBatches[workerId];
+    for (TraderId traderId : batch.touched) {
+      auto &statuses = batch.outbox[traderId];
+      if (traderId < mSessions.size() &&
+          mSessions[traderId].open.load(std::memory_order_acquire)) {
+        mSessions[traderId].egress->asyncWrite(Span<OrderStatus>(statuses));
+      }
+      statuses.clear();
+    }
+    batch.touched.clear();
+  }
+
+  void processOrder(ThreadId workerId, TickerId tickerId, const Order &order) {
+    auto &entry = mBooks[tickerId];
+    auto &batch = mBatches[workerId];
+    if (entry.owner.load(std::memory_order_acquire) != workerId) {
+      // Routed here after the switch while the old owner still drains its queue
+      batch.deferred[tickerId].push_back(order);
+      return;
+    }
+    if (!batch.deferred.empty()) [[unlikely]] {
+      replayDeferred(workerId, tickerId);
+    }
+    if (entry.book.slab() != mSlabs[workerId].get()) [[unlikely]] {
+      adoptBook(workerId, entry);
+    }
+    const uint64_t sequence = ++entry.sequence;
+    Journal *journal = mJournals.empty() ? nullptr : mJournals[workerId].get();
+    if (journal != nullptr) {
+      journal->appendOrder(sequence, order);
+    }
+    auto statuses = executeOrder(entry, order);
+    TickerPrice quote;
+    entry.book.quote(quote);
+    mFeed->update(tickerId, quote);
+    mRisk->onTrade(tickerId, quote.price);
+    if (journal != nullptr) {
+      for (auto &status : statuses) {
+        journal->appendFill(sequence, status);
+      }
+    }
+    if (mTrades != nullptr) {
+      for (auto &status : statuses) {
+        if (status.state == OrderState::Partial || status.state == OrderState::Full) {
+          mTrades->push(status);
+        }
+      }
+    }
+    if (mCapture != nullptr) {
+      for (auto &status : statuses) {
+        if (status.state == OrderState::Partial || status.state == OrderState::Full) {
+          mCapture->pushFill(workerId, status);
+        }
+      }
+    }
+    // Resting orders and triggered stops may report to other sessions than the one of the order
+    for (auto &status : statuses) {
+      const TraderId slot = slotOf(status.traderId);
+      auto &pending = batch.outbox[slot];
+      if (pending.empty()) {
+        batch.touched.push_back(slot);
+      }
+      pending.push_back(status);
+    }
+  }
+
+  /**
+   * @brief Slot in per session tables, recovered traders beyond the session table share
+   * the extra one past it
+   */
+  inline TraderId slotOf(TraderId traderId) const {
+    return std::min<TraderId>(traderId, mSessions.size());
+  }
+
+  /**
+   * @brief Releases risk of every order that is done: filled resting ones and the incoming
+   * one once it is fully filled, cancelled or rejected
+   */
+  std::vector<OrderStatus> executeOrder(BookEntry &entry, const Order &order) {
+    auto statuses = entry.book.execute(order, [this](const Order &resting) {
+      mRisk->onClosed(slotOf(resting.traderId));
+    });
+    // Statuses of resting orders carry the Resting flag and partial self trade cancels
+    // the Partial one, both fall through. Resting orders are released by the callback
+    // above, fills are counted once with the incoming order
+    for (auto &status : statuses) {
+      switch (status.state) {
+      case OrderState::Partial:
+        mOrdersClosed.fetch_add(1, std::memory_order_relaxed);
+        break;
+      case OrderState::Full:
+        mOrdersClosed.fetch_add(1, std::memory_order_relaxed);
+        mRisk->onClosed(slotOf(status.traderId));
+        break;
+      case OrderState::Cancelled:
+        mOrdersCancelled.fetch_add(1, std::memory_order_relaxed);
+        mRisk->onClosed(slotOf(status.traderId));
+        break;
+      case OrderState::Rejected:
+        mOrdersRejected.fetch_add(1, std::memory_order_relaxed);
+        mRisk->onClosed(slotOf(status.traderId));
+        break;
+      default:
+        break;
+      }
+    }
+    return statuses;
+  }
+
+  /**
+   * @brief Routing switches right away, the old owner gives the book up only after it has
+   * processed everything queued before the switch, then the new owner replays deferred orders
+   */
+  void migrate(const TickerRouter::Migration &migration) {
+    auto tickerId = migration.tickerId;
+    auto from = migration.from;
+    auto to = migration.to;
+    boost::asio::post(*mWorkerContexts[from], [this, tickerId, from, to]() {
+      // Inbox may still hold orders routed before the switch
+      for (size_t queued = mInboxes[from]->depth(); queued != 0;) {
+        const size_t drained = drainBatch(from, std::min(queued, mBatchSize));
+        if (drained == 0) {
+          break;
+        }
+        queued -= drained;
+      }
+      mBooks[tickerId].book.park();
+      mBooks[tickerId].owner.store(to, std::memory_order_release);
+      boost::asio::post(*mWorkerContexts[to], [this, tickerId, to]() {
+        replayDeferred(to, tickerId);
+        flushStatuses(to);
+        boost::asio::post(mCtx, [this, tickerId]() { mRouter->onMigrated(tickerId); });
+      });
+    });
+  }
+
+  /**
+   * @brief Orders held while the book was on its way, in arrival order. Runs before anything
+   * newer for the ticker, whichever comes first of the hand-off post and a new order
+   */
+  void replayDeferred(ThreadId workerId, TickerId tickerId) {
+    auto &deferred = mBatches[workerId].deferred;
+    auto held = deferred.find(tickerId);
+    if (held == deferred.end()) {
+      return;
+    }
+    auto orders = std::move(held->second);
+    deferred.erase(held);
+    for (auto &order : orders) {
+      processOrder(workerId, tickerId, order);
+    }
+  }
+
+  /**
+   * @brief Takes a migrated book into the slab of its new owner
+   */
+  void adoptBook(ThreadId workerId, BookEntry &entry) {
+    entry.book.adopt(*mSlabs[workerId], [this, workerId](const Order &order) {
+      HFT_LOG_ERROR("Order slab of worker {} is full, dropped {}", workerId, order);
+      mRisk->onClosed(order.traderId);
+    });
+  }
+
+  void scheduleRebalanceTimer() {
+    if (mRebalanceRateS == 0) {
+      return;
+    }
+    mRebalanceTimer.expires_after(Seconds(mRebalanceRateS));
+    mRebalanceTimer.async_wait([this](BoostErrorRef ec) {
+      if (ec) {
+        return;
+      }
+      auto migrations = mRouter->rebalance(Config::cfg.rebalanceSkew, MAX_MIGRATIONS);
+      for (auto &migration : migrations) {
+        Logger::monitorLogger->info("Migrating {} load:{} worker {} -> {}",
+                                    utils::toStrView(mTickerIndex.ticker(migration.tickerId)),
+                                    mRouter->load(migration.tickerId), migration.from,
+                                    migration.to);
+        migrate(migration);
+      }
+      scheduleRebalanceTimer();
     });
   }
 
   void initMarketData() {
-    mPrices = db::PostgresAdapter::readTickers();
-    for (auto &item : mPrices) {
-      mOrderBooks.insert({utils::getTickerHash(item.ticker), OrderBook{}});
+    mPrices = db::TickerProvider::create()->readTickers();
+    mTickerIndex.build(mPrices);
+    mFeed = std::make_unique<PriceFeed>(mCtx, mTickerIndex, mPrices);
+    mFeed->addChannel(Config::cfg.portUdp, mPriceRateUs);
+    if (Config::cfg.portUdpConflated != 0) {
+      mFeed->addChannel(Config::cfg.portUdpConflated, Config::cfg.priceConflatedRateUs);
+    }
+    mBooks = std::vector<BookEntry>(mTickerIndex.size());
+    mRouter = std::make_unique<TickerRouter>(mTickerIndex.size(), Config::cfg.coreIds.size());
+    // Extra slot past the session table holds recovered orders of traders beyond it
+    mRisk = std::make_unique<RiskChecker>(mSessions.size() + 1, mTickerIndex.size());
+    for (auto &tickerPrice : mPrices) {
+      mRisk->setReferencePrice(mTickerIndex.find(tickerPrice.ticker), tickerPrice.price);
+    }
+    for (size_t i = 0; i < Config::cfg.coreIds.size(); ++i) {
+      mSlabs.emplace_back(std::make_unique<OrderSlab>(Config::cfg.orderSlabSize));
+    }
+    for (TickerId id = 0; id < mBooks.size(); ++id) {
+      mBooks[id].owner = mRouter->route(id);
+      mBooks[id].book.adopt(*mSlabs[mBooks[id].owner]);
     }
     Logger::monitorLogger->info(std::format("Market data loaded for {} tickers", mPrices.size()));
+    recoverBooks();
+  }
+
+  /**
+   * @brief Loads the latest snapshot and replays the journal tail of every book after it.
+   * Orders keep their traders and self trade prevention is on, so books match the ones
+   * before the restart. Sessions holding recovered orders stay retired until those close,
+   * so a new trader is never taken for the owner of an old order
+   */
+  void recoverBooks() {
+    const auto start = std::chrono::steady_clock::now();
+    const auto selfTrade = parseSelfTradePrevention(Config::cfg.selfTrade);
+    for (auto &entry : mBooks) {
+      entry.book.setSelfTradePrevention(selfTrade);
+    }
+    const size_t restored = loadSnapshot();
+    const size_t replayed = replayJournal();
+    // Feed and collars start from the recovered trade prices instead of the database ones
+    for (TickerId id = 0; id < mBooks.size(); ++id) {
+      TickerPrice quote;
+      mBooks[id].book.quote(quote);
+      mFeed->update(id, quote);
+      mRisk->onTrade(id, quote.price);
+      mRisk->refreshReference(id);
+    }
+    std::erase_if(mFreeSessions, [this](TraderId traderId) {
+      if (mRisk->openOrders(traderId) == 0) {
+        return false;
+      }
+      mSessions[traderId].state = Session::State::Retired;
+      mRetiredSessions.push_back(traderId);
+      return true;
+    });
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    if (restored != 0 || replayed != 0) {
+      Logger::monitorLogger->info("Recovered {} resting orders from snapshot, replayed {} "
+                                  "journal orders in {}ms",
+                                  restored, replayed, elapsed.count());
+    }
+  }
+
+  size_t loadSnapshot() {
+    if (Config::cfg.snapshotPath.empty()) {
+      return 0;
+    }
+    auto books = Snapshot::readLatest(Config::cfg.snapshotPath);
+    if (!books.has_value()) {
+      return 0;
+    }
+    size_t restored = 0;
+    for (auto &snapshot : *books) {
+      TickerId tickerId = mTickerIndex.find(snapshot.ticker);
+      if (tickerId == INVALID_TICKER_ID) {
+        Logger::monitorLogger->error("Unknown ticker {} in snapshot",
+                                     utils::toStrView(snapshot.ticker));
+        continue;
+      }
+      for (auto *side : {&snapshot.bids, &snapshot.asks}) {
+        for (auto &resting : *side) {
+          mRisk->onRecovered(slotOf(resting.order.traderId));
+        }
+        restored += side->size();
+      }
+      for (auto &order : snapshot.stops) {
+        mRisk->onRecovered(slotOf(order.traderId));
+      }
+      restored += snapshot.stops.size();
+      auto &entry = mBooks[tickerId];
+      entry.book.restore(snapshot.bids, snapshot.asks, snapshot.stops, snapshot.lastPrice);
+      entry.sequence = snapshot.sequence;
+    }
+    auto &sequences = mSnapshotSequences.emplace_back(mBooks.size(), 0);
+    for (TickerId id = 0; id < mBooks.size(); ++id) {
+      sequences[id] = mBooks[id].sequence;
+    }
+    return restored;
+  }
+
+  /**
+   * @brief Replays journaled orders of every ticker in sequence order through the same
+   * matching path, fills are not replayed as matching reproduces them.
+   * Orders already covered by the snapshot are skipped
+   */
+  size_t replayJournal() {
+    if (Config::cfg.journalPath.empty()) {
+      return 0;
+    }
+    struct Replayed {
+      TickerId tickerId;
+      uint64_t sequence;
+      Order order;
+    };
+    std::vector<Replayed> orders;
+    for (auto &record : Journal::read(Config::cfg.journalPath)) {
+      if (record.type != JournalRecord::Type::Order) {
+        continue;
+      }
+      Replayed replayed{INVALID_TICKER_ID, record.sequence, {}};
+      std::memcpy(&replayed.order, record.payload, sizeof(Order));
+      replayed.tickerId = mTickerIndex.find(replayed.order.ticker);
+      if (replayed.tickerId == INVALID_TICKER_ID) {
+        Logger::monitorLogger->error("Unknown ticker {} in journal",
+                                     utils::toStrView(replayed.order.ticker));
+        continue;
+      }
+      if (replayed.sequence > mBooks[replayed.tickerId].sequence) {
+        orders.push_back(replayed);
+      }
+    }
+    std::sort(orders.begin(), orders.end(), [](const Replayed &left, const Replayed &right) {
+      return left.tickerId != right.tickerId ? left.tickerId < right.tickerId
+                                             : left.sequence < right.sequence;
+    });
+    for (auto &replayed : orders) {
+      auto &entry = mBooks[replayed.tickerId];
+      mRisk->onRecovered(slotOf(replayed.order.traderId));
+      executeOrder(entry, replayed.order);
+      entry.sequence = replayed.sequence;
+    }
+    return orders.size();
+  }
+
+  void startSnapshots() {
+    if (Config::cfg.snapshotPath.empty() || Config::cfg.snapshotRateS == 0) {
+      return;
+    }
+    mSnapshotGuard = std::make_unique<ContextGuard>(boost::asio::make_work_guard(mSnapshotCtx));
+    mSnapshotThread = std::thread([this]() {
+      try {
+        mSnapshotCtx.run();
+      } catch (const std::exception &e) {
+        Logger::monitorLogger->error("Exception in snapshot thread {}", e.what());
+      }
+    });
+    scheduleSnapshotTimer();
+  }
+
+  void scheduleSnapshotTimer() {
+    mSnapshotTimer.expires_after(Seconds(Config::cfg.snapshotRateS));
+    mSnapshotTimer.async_wait([this](BoostErrorRef ec) {
+      if (ec) {
+        return;
+      }
+      if (!mSnapshotInProgress) {
+        mSnapshotInProgress = true;
+        auto round = std::make_shared<SnapshotRound>(mBooks.size(), mWorkerContexts.size());
+        for (ThreadId id = 0; id < mWorkerContexts.size(); ++id) {
+          boost::asio::post(*mWorkerContexts[id],
+                            [this, id, round]() { collectSnapshot(id, round, 0); });
+        }
+      }
+      scheduleSnapshotTimer();
+    });
+  }
+
+  void collectSnapshot(ThreadId workerId, std::shared_ptr<SnapshotRound> round, TickerId from) {
+    const TickerId to = std::min<size_t>(from + SNAPSHOT_CHUNK, mBooks.size());
+    for (TickerId id = from; id < to; ++id) {
+      auto &entry = mBooks[id];
+      if (entry.owner.load(std::memory_order_acquire) != workerId ||
+          round->taken[id].exchange(true, std::memory_order_acq_rel)) {
+        continue;
+      }
+      if (entry.book.slab() != mSlabs[workerId].get()) {
+        adoptBook(workerId, entry);
+      }
+      auto &snapshot = round->books[id];
+      snapshot.ticker = mTickerIndex.ticker(id);
+      snapshot.sequence = entry.sequence;
+      snapshot.lastPrice = entry.book.lastPrice();
+      snapshot.bids = entry.book.bids();
+      snapshot.asks = entry.book.asks();
+      snapshot.stops = entry.book.stops();
+    }
+    if (to < mBooks.size()) {
+      boost::asio::post(*mWorkerContexts[workerId],
+                        [this, workerId, round, to]() { collectSnapshot(workerId, round, to); });
+    } else if (round->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      boost::asio::post(mSnapshotCtx, [this, round]() { writeSnapshot(*round); });
+    }
+  }
+
+  void writeSnapshot(const SnapshotRound &round) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t orders = 0;
+    bool complete = true;
+    for (size_t id = 0; id < round.books.size(); ++id) {
+      complete = complete && round.taken[id].load(std::memory_order_acquire);
+      orders += round.books[id].bids.size() + round.books[id].asks.size() +
+                round.books[id].stops.size();
+    }
+    if (!complete) {
+      Logger::monitorLogger->warn("Snapshot skipped, books migrated while collecting");
+    } else {
+      try {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count();
+        Snapshot::write(Config::cfg.snapshotPath, timestamp, round.books);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        Logger::monitorLogger->info("Snapshot of {} books {} orders written in {}ms",
+                                    round.books.size(), orders, elapsed.count());
+        auto &sequences = mSnapshotSequences.emplace_back(round.books.size(), 0);
+        for (size_t id = 0; id < round.books.size(); ++id) {
+          sequences[id] = round.books[id].sequence;
+        }
+        if (mSnapshotSequences.size() > Snapshot::KEEP_LAST) {
+          mSnapshotSequences.pop_front();
+        }
+        if (mSnapshotSequences.size() == Snapshot::KEEP_LAST) {
+          retireJournal(mSnapshotSequences.front());
+        }
+      } catch (const std::exception &e) {
+        Logger::monitorLogger->error(e.what());
+      }
+    }
+    boost::asio::post(mCtx, [this]() { mSnapshotInProgress = false; });
+  }
+
+  /**
+   * @brief Deletes journal segments replay no longer needs, every record in them is covered
+   * by the oldest snapshot kept on disk, so recovery from either one still finds its tail
+   */
+  void retireJournal(const std::vector<uint64_t> &sequences) {
+    if (mJournals.empty()) {
+      return;
+    }
+    std::vector<size_t> activeIndices;
+    for (auto &journal : mJournals) {
+      activeIndices.push_back(journal->activeIndex());
+    }
+    const size_t retired = Journal::retire(
+        Config::cfg.journalPath, activeIndices, [this, &sequences](const JournalRecord &record) {
+          Ticker ticker{};
+          if (record.type == JournalRecord::Type::Order) {
+            std::memcpy(&ticker, record.payload + offsetof(Order, ticker), sizeof(Ticker));
+          } else {
+            std::memcpy(&ticker, record.payload + offsetof(OrderStatus, ticker), sizeof(Ticker));
+          }
+          // Replay skips unknown tickers as well
+          const TickerId tickerId = mTickerIndex.find(ticker);
+          return tickerId == INVALID_TICKER_ID || record.sequence <= sequences[tickerId];
+        });
+    if (retired != 0) {
+      Logger::monitorLogger->info("Retired {} journal segments covered by snapshots", retired);
+    }
+  }
+
+  void startPersistence() {
+    db::TradeSink::UPtr sink;
+    if (Config::cfg.tradeSink == "postgres") {
+      sink = std::make_unique<db::PostgresTradeSink>();
+    } else if (Config::cfg.tradeSink == "file") {
+      sink = std::make_unique<db::FileTradeSink>(Config::cfg.tradeFile);
+    } else {
+      return;
+    }
+    mTrades = std::make_unique<db::TradePersister>(std::move(sink), Config::cfg.tradeQueueSize,
+                                                   Config::cfg.tradeBatchSize);
+  }
+
+  void startJournal() {
+    if (Config::cfg.journalPath.empty()) {
+      return;
+    }
+    for (ThreadId id = 0; id < Config::cfg.coreIds.size(); ++id) {
+      mJournals.emplace_back(std::make_unique<Journal>(Config::cfg.journalPath, id,
+                                                       Config::cfg.journalSegmentMb << 20));
+    }
+    mJournalRunning.store(true, std::memory_order_release);
+    mJournalThread = std::thread([this]() {
+      try {
+        while (mJournalRunning.load(std::memory_order_acquire)) {
+          std::this_thread::sleep_for(std::chrono::microseconds(Config::cfg.journalSyncUs));
+          for (auto &journal : mJournals) {
+            journal->sync();
+          }
+        }
+      } catch (const std::exception &e) {
+        Logger::monitorLogger->error("Exception in journal thread {}", e.what());
+      }
+    });
+  }
+
+  void startCapture() {
+    if (Config::cfg.capturePath.empty()) {
+      return;
+    }
+    mCapture = std::make_unique<OrderCapture>(
+        Config::cfg.capturePath, Config::cfg.coreIds.size(), Config::cfg.captureQueueSize,
+        parseSelfTradePrevention(Config::cfg.selfTrade));
+    Logger::monitorLogger->info("Capturing order flow to {}", Config::cfg.capturePath);
   }
 
   void scheduleInputTimer() {
@@ -185,9 +989,43 @@ private:
       size_t ordersCurrent = mOrdersTotal.load(std::memory_order_relaxed);
       auto rps = (ordersCurrent - lastOrderCount) / mStatsRateS;
       if (rps != 0) {
-        Logger::monitorLogger->info("Orders [matched|total] {} {} rps:{}",
+        Logger::monitorLogger->info("Orders [matched|cancelled|rejected|total] {} {} {} {} "
+                                    "rps:{}",
                                     mOrdersClosed.load(std::memory_order_relaxed),
+                                    mOrdersCancelled.load(std::memory_order_relaxed),
+                                    mOrdersRejected.load(std::memory_order_relaxed),
                                     mOrdersTotal.load(std::memory_order_relaxed), rps);
+        RiskTracker::printStats();
+        if (mTrades != nullptr) {
+          auto stats = mTrades->stats();
+          Logger::monitorLogger->info("Trades [written|pending|dropped|failed] {} {} {} {} "
+                                      "maxDepth:{}",
+                                      stats.written, stats.pending(),
+                                      stats.dropped, stats.failed, stats.maxDepth);
+        }
+        if (mCapture != nullptr) {
+          Logger::monitorLogger->info("Capture [written|dropped] {} {}", mCapture->written(),
+                                      mCapture->dropped());
+        }
+        for (size_t i = 0; i < mSlabs.size(); ++i) {
+          Logger::monitorLogger->info("Worker {} order slab [occupancy|capacity] {} {}", i,
+                                      mSlabs[i]->occupancy(), mSlabs[i]->capacity());
+          const size_t batches = mInboxes[i]->batches();
+          Logger::monitorLogger->info("Worker {} [queued|batches|avgBatch] {} {} {:.1f}", i,
+                                      mInboxes[i]->depth(), batches,
+                                      batches == 0 ? 0.0 : double(mInboxes[i]->popped()) / batches);
+        }
+        for (auto &feed : mFeed->stats()) {
+          Logger::monitorLogger->info("Feed {} every {}us [ticks|published] {} {}", feed.port,
+                                      feed.rateUs, feed.ticks, feed.published);
+        }
+        for (auto &pool : BufferPool::instance().stats()) {
+          if (pool.capacity != 0) {
+            Logger::monitorLogger->info("Pool {}B [inUse|highWater|capacity] {} {} {}",
+                                        pool.blockSize, pool.inUse, pool.highWater,
+                                        pool.capacity);
+          }
+        }
       }
       lastOrderCount = ordersCurrent;
       scheduleStatsTimer();
@@ -200,26 +1038,24 @@ private:
       if (ec) {
         return;
       }
-      updatePrices();
+      simulatePrices();
       schedulePriceTimer();
     });
   }
 
-  void updatePrices() {
-    static auto cursor = mPrices.begin();
+  /**
+   * @brief Moves a few prices per tick for runs without much trading, they go out through
+   * the feed along with trade prices. Risk collars follow trades only
+   */
+  void simulatePrices() {
+    static TickerId cursor = 0;
     const auto pricesPerUpdate = 5;
-    std::vector<TickerPrice> priceUpdates;
-    priceUpdates.reserve(pricesPerUpdate);
     for (int i = 0; i < pricesPerUpdate; ++i) {
-      if (cursor == mPrices.end()) {
-        cursor = mPrices.begin();
-      }
-      auto tickerPrice = *cursor++;
-      tickerPrice.price = utils::getLinuxTimestamp() % 777;
-      priceUpdates.emplace_back(std::move(tickerPrice));
-      spdlog::trace([&tickerPrice] { return utils::toString(tickerPrice); }());
+      cursor = (cursor + 1) % mTickerIndex.size();
+      const Price price = utils::getLinuxTimestamp() % 777;
+      mFeed->updatePrice(cursor, price);
+      HFT_LOG_TRACE("{} {}", utils::toStrView(mTickerIndex.ticker(cursor)), price);
     }
-    mPricesSocket.asyncWrite(Span<TickerPrice>(priceUpdates));
   }
 
   void checkInput() {
@@ -228,6 +1064,7 @@ private:
       std::string cmd;
       std::getline(std::cin, cmd);
       if (cmd == "q") {
+        mFeed->stop();
         mCtx.stop();
         for (auto &ctx : mWorkerContexts) {
           ctx->stop();
@@ -247,25 +1084,53 @@ private:
 
   TcpAcceptor mIngressAcceptor;
   TcpAcceptor mEgressAcceptor;
-  ServerUdpSocket mPricesSocket;
 
   SteadyTimer mInputTimer;
   SteadyTimer mStatsTimer;
   SteadyTimer mPriceTimer;
+  SteadyTimer mRebalanceTimer;
+  SteadyTimer mSnapshotTimer;
 
   size_t mStatsRateS;
   size_t mPriceRateUs;
+  size_t mRebalanceRateS;
 
   std::vector<UPtrIoContext> mWorkerContexts;
   std::vector<UPtrContextGuard> mWorkerGuards;
   std::vector<std::thread> mWorkerThreads;
+  std::vector<WorkerInbox::UPtr> mInboxes;
+  std::vector<WorkerBatch> mBatches;
+  size_t mBatchSize{1};
+
+  std::vector<Journal::UPtr> mJournals;
+  std::thread mJournalThread;
+  std::atomic_bool mJournalRunning{false};
+
+  IoContext mSnapshotCtx;
+  UPtrContextGuard mSnapshotGuard;
+  std::thread mSnapshotThread;
+  bool mSnapshotInProgress{false};
+  std::deque<std::vector<uint64_t>> mSnapshotSequences; // Kept snapshots, oldest first
 
-  std::unordered_map<size_t, Session> mSessions;
-  std::unordered_map<size_t, OrderBook> mOrderBooks;
+  std::vector<Session> mSessions;
+  std::vector<TraderId> mFreeSessions;
+  std::vector<TraderId> mRetiredSessions;
+  std::unordered_map<size_t, EgressSocket::UPtr> mPendingEgress;
+  size_t mNextPendingId{0};
+  TickerIndex mTickerIndex;
+  std::unique_ptr<TickerRouter> mRouter;
+  std::unique_ptr<RiskChecker> mRisk;
+  std::unique_ptr<PriceFeed> mFeed;
+  db::TradePersister::UPtr mTrades;
+  OrderCapture::UPtr mCapture;
+  std::vector<OrderSlab::UPtr> mSlabs;
+  std::vector<BookEntry> mBooks;
   std::vector<TickerPrice> mPrices;
 
   std::atomic_size_t mOrdersTotal;
   std::atomic_size_t mOrdersClosed;
+  std::atomic_size_t mOrdersCancelled;
+  std::atomic_size_t mOrdersRejected;
 };
 
 } // namespace hft::server
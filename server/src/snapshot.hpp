@@ -0,0 +1,209 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-11
+ */
+
+#ifndef HFT_SERVER_SNAPSHOT_HPP
+#define HFT_SERVER_SNAPSHOT_HPP
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "market_types.hpp"
+#include "order_slab.hpp"
+#include "types.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Resting orders of one book in priority order and the journal sequence
+ * of the last order applied, journal tail of the ticker starts right after it.
+ * Resting orders carry their shown quantity, held stops and the last trade price
+ * they are triggered by go along
+ */
+struct BookSnapshot {
+  Ticker ticker{};
+  Price lastPrice{0};
+  uint64_t sequence{0};
+  std::vector<RestingOrder> bids;
+  std::vector<RestingOrder> asks;
+  std::vector<Order> stops;
+};
+
+/**
+ * @brief Versioned snapshot file of all books. Written to a temporary file that is
+ * synced and renamed, so a snapshot on disk is always complete
+ */
+class Snapshot {
+  static constexpr uint32_t MAGIC = 0x53544648; // HFTS
+  static constexpr uint32_t VERSION = 3;
+  static constexpr const char *EXTENSION = ".snapshot";
+
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t bookCount;
+  };
+  struct BookHeader {
+    Ticker ticker;
+    Price lastPrice;
+    uint64_t sequence;
+    uint64_t bidCount;
+    uint64_t askCount;
+    uint64_t stopCount;
+  };
+
+public:
+  static constexpr size_t KEEP_LAST = 2;
+
+  static void write(const std::string &dir, uint64_t timestamp,
+                    const std::vector<BookSnapshot> &books) {
+    std::filesystem::create_directories(dir);
+    const auto path = std::format("{}/{:020}{}", dir, timestamp, EXTENSION);
+    const auto tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) {
+      throw std::runtime_error(std::format("Failed to create snapshot {}", tmpPath));
+    }
+    bool ok = put(file, FileHeader{MAGIC, VERSION, books.size()});
+    for (auto &book : books) {
+      ok = ok && put(file, BookHeader{book.ticker, book.lastPrice, book.sequence,
+                                      book.bids.size(), book.asks.size(), book.stops.size()});
+      ok = ok && putOrders(file, book.bids) && putOrders(file, book.asks) &&
+           putOrders(file, book.stops);
+    }
+    ok = ok && put(file, MAGIC);
+    ok = ok && fflush(file) == 0 && fdatasync(fileno(file)) == 0;
+    fclose(file);
+    if (!ok) {
+      std::filesystem::remove(tmpPath);
+      throw std::runtime_error(std::format("Failed to write snapshot {}", tmpPath));
+    }
+    std::filesystem::rename(tmpPath, path);
+    syncDir(dir);
+    removeOld(dir);
+  }
+
+  /**
+   * @brief Loads the most recent snapshot, incomplete or foreign version files are skipped
+   */
+  static std::optional<std::vector<BookSnapshot>> readLatest(const std::string &dir) {
+    auto files = list(dir);
+    for (auto it = files.rbegin(); it != files.rend(); ++it) {
+      auto books = read(*it);
+      if (books.has_value()) {
+        return books;
+      }
+    }
+    return std::nullopt;
+  }
+
+private:
+  static std::optional<std::vector<BookSnapshot>> read(const std::filesystem::path &path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return std::nullopt;
+    }
+    // Counts are checked against the file size before anything gets allocated
+    const size_t fileSize = std::filesystem::file_size(path);
+    std::vector<BookSnapshot> books;
+    FileHeader header{};
+    bool ok = get(file, header) && header.magic == MAGIC && header.version == VERSION &&
+              header.bookCount <= fileSize / sizeof(BookHeader);
+    if (ok) {
+      books.resize(header.bookCount);
+    }
+    for (size_t i = 0; ok && i < books.size(); ++i) {
+      BookHeader bookHeader{};
+      ok = get(file, bookHeader) &&
+           bookHeader.bidCount + bookHeader.askCount + bookHeader.stopCount <=
+               fileSize / sizeof(Order);
+      if (!ok) {
+        break;
+      }
+      books[i].ticker = bookHeader.ticker;
+      books[i].lastPrice = bookHeader.lastPrice;
+      books[i].sequence = bookHeader.sequence;
+      books[i].bids.resize(bookHeader.bidCount);
+      books[i].asks.resize(bookHeader.askCount);
+      books[i].stops.resize(bookHeader.stopCount);
+      ok = getOrders(file, books[i].bids) && getOrders(file, books[i].asks) &&
+           getOrders(file, books[i].stops);
+    }
+    uint32_t trailer{0};
+    ok = ok && get(file, trailer) && trailer == MAGIC;
+    fclose(file);
+    if (!ok) {
+      return std::nullopt;
+    }
+    return books;
+  }
+
+  static std::vector<std::filesystem::path> list(const std::string &dir) {
+    std::vector<std::filesystem::path> files;
+    if (!std::filesystem::exists(dir)) {
+      return files;
+    }
+    for (auto &entry : std::filesystem::directory_iterator(dir)) {
+      if (entry.path().extension() == EXTENSION) {
+        files.push_back(entry.path());
+      }
+    }
+    // Zero padded timestamps sort chronologically
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  /**
+   * @brief Makes the rename durable, a crash could bring the directory back without it
+   */
+  static void syncDir(const std::string &dir) {
+    const int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    const bool ok = fd != -1 && fsync(fd) == 0;
+    if (fd != -1) {
+      close(fd);
+    }
+    if (!ok) {
+      throw std::runtime_error(std::format("Failed to sync snapshot directory {}", dir));
+    }
+  }
+
+  static void removeOld(const std::string &dir) {
+    auto files = list(dir);
+    for (size_t i = 0; i + KEEP_LAST < files.size(); ++i) {
+      std::filesystem::remove(files[i]);
+    }
+  }
+
+  template <typename Type>
+  static bool put(FILE *file, const Type &value) {
+    return fwrite(&value, sizeof(Type), 1, file) == 1;
+  }
+  template <typename Type>
+  static bool putOrders(FILE *file, const std::vector<Type> &orders) {
+    return orders.empty() || fwrite(orders.data(), sizeof(Type), orders.size(), file) ==
+                                 orders.size();
+  }
+  template <typename Type>
+  static bool get(FILE *file, Type &value) {
+    return fread(&value, sizeof(Type), 1, file) == 1;
+  }
+  template <typename Type>
+  static bool getOrders(FILE *file, std::vector<Type> &orders) {
+    return orders.empty() ||
+           fread(orders.data(), sizeof(Type), orders.size(), file) == orders.size();
+  }
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_SNAPSHOT_HPP
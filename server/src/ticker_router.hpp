@@ -0,0 +1,136 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-06
+ */
+
+#ifndef HFT_SERVER_TICKERROUTER_HPP
+#define HFT_SERVER_TICKERROUTER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "market_types.hpp"
+#include "types.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Ticker to worker routing with per ticker load counters
+ * Routing table is immutable once published, updates build a copy and swap the pointer.
+ * Replaced tables are kept until the next publish, which is a grace period long enough
+ * for any reader that loaded the old pointer during a single dispatch
+ */
+class TickerRouter {
+  using RoutingTable = std::vector<ThreadId>;
+
+public:
+  struct Migration {
+    TickerId tickerId;
+    ThreadId from;
+    ThreadId to;
+  };
+
+  TickerRouter(size_t tickers, size_t workers)
+      : mWorkers{workers}, mLoad(tickers, 0), mMigrating(tickers, false) {
+    auto table = std::make_unique<RoutingTable>(tickers);
+    for (size_t i = 0; i < tickers; ++i) {
+      (*table)[i] = i % workers;
+    }
+    mTable.store(table.get(), std::memory_order_release);
+    mCurrent = std::move(table);
+  }
+
+  inline ThreadId route(TickerId tickerId) const {
+    return (*mTable.load(std::memory_order_acquire))[tickerId];
+  }
+
+  inline void count(TickerId tickerId) { ++mLoad[tickerId]; }
+
+  /**
+   * @brief Moves hottest tickers off the busiest worker to the idlest one while it reduces
+   * the gap between them. Counters are halved afterwards so old load fades out
+   */
+  std::vector<Migration> rebalance(double skewThreshold, size_t maxMigrations) {
+    std::vector<Migration> migrations;
+    const RoutingTable &table = *mCurrent;
+    std::vector<uint64_t> workerLoad(mWorkers, 0);
+    uint64_t total = 0;
+    for (size_t i = 0; i < table.size(); ++i) {
+      workerLoad[table[i]] += mLoad[i];
+      total += mLoad[i];
+    }
+    const double average = static_cast<double>(total) / mWorkers;
+    auto maxIt = std::max_element(workerLoad.begin(), workerLoad.end());
+    if (total == 0 || *maxIt < average * skewThreshold) {
+      decay();
+      return migrations;
+    }
+
+    RoutingTable next = table;
+    while (migrations.size() < maxMigrations) {
+      ThreadId busiest =
+          std::max_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin();
+      ThreadId idlest =
+          std::min_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin();
+      const uint64_t gap = workerLoad[busiest] - workerLoad[idlest];
+
+      // Hottest ticker that still narrows the gap when moved
+      TickerId candidate = INVALID_TICKER_ID;
+      for (TickerId id = 0; id < next.size(); ++id) {
+        if (next[id] != busiest || mMigrating[id] || mLoad[id] == 0 || mLoad[id] >= gap) {
+          continue;
+        }
+        if (candidate == INVALID_TICKER_ID || mLoad[id] > mLoad[candidate]) {
+          candidate = id;
+        }
+      }
+      if (candidate == INVALID_TICKER_ID) {
+        break;
+      }
+      next[candidate] = idlest;
+      workerLoad[busiest] -= mLoad[candidate];
+      workerLoad[idlest] += mLoad[candidate];
+      mMigrating[candidate] = true;
+      migrations.push_back({candidate, busiest, idlest});
+    }
+    if (!migrations.empty()) {
+      publish(std::move(next));
+    }
+    decay();
+    return migrations;
+  }
+
+  void onMigrated(TickerId tickerId) { mMigrating[tickerId] = false; }
+
+  uint64_t load(TickerId tickerId) const { return mLoad[tickerId]; }
+
+private:
+  void publish(RoutingTable &&table) {
+    auto next = std::make_unique<RoutingTable>(std::move(table));
+    mTable.store(next.get(), std::memory_order_release);
+    mRetired = std::move(mCurrent);
+    mCurrent = std::move(next);
+  }
+
+  void decay() {
+    for (auto &load : mLoad) {
+      load /= 2;
+    }
+  }
+
+private:
+  const size_t mWorkers;
+
+  std::atomic<const RoutingTable *> mTable;
+  std::unique_ptr<RoutingTable> mCurrent;
+  std::unique_ptr<RoutingTable> mRetired;
+
+  std::vector<uint64_t> mLoad;
+  std::vector<bool> mMigrating;
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_TICKERROUTER_HPP
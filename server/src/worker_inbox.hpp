@@ -0,0 +1,83 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-18
+ */
+
+#ifndef HFT_SERVER_WORKERINBOX_HPP
+#define HFT_SERVER_WORKERINBOX_HPP
+
+#include <atomic>
+#include <memory>
+
+#include "market_types.hpp"
+#include "template_types.hpp"
+#include "types.hpp"
+
+namespace hft::server {
+
+/**
+ * @brief Orders routed to one worker. Network thread pushes into a single producer ring and
+ * schedules a drain only when none is pending, so a burst costs one handler on the worker.
+ * Only the owning worker pops
+ */
+class WorkerInbox {
+public:
+  using UPtr = std::unique_ptr<WorkerInbox>;
+
+  struct Item {
+    TickerId tickerId;
+    Order order;
+  };
+
+  explicit WorkerInbox(size_t capacity) : mQueue{capacity} {}
+
+  WorkerInbox(const WorkerInbox &) = delete;
+  WorkerInbox &operator=(const WorkerInbox &) = delete;
+
+  /**
+   * @brief Returns false when the queue is full
+   */
+  inline bool push(TickerId tickerId, const Order &order) {
+    return mQueue.push(Item{tickerId, order});
+  }
+
+  /**
+   * @brief Returns true if the caller has to post a drain, pairs with release
+   */
+  inline bool schedule() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return !mScheduled.exchange(true, std::memory_order_acq_rel);
+  }
+
+  /**
+   * @brief Called by the worker after its last drain. Returns true if orders arrived in
+   * the meantime and the worker took the drain back, so it has to post it again
+   */
+  inline bool release() {
+    mScheduled.store(false, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return mQueue.read_available() != 0 && schedule();
+  }
+
+  inline size_t pop(Item *items, size_t count) {
+    const size_t popped = mQueue.pop(items, count);
+    mBatches.store(mBatches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    mPopped.store(mPopped.load(std::memory_order_relaxed) + popped, std::memory_order_relaxed);
+    return popped;
+  }
+
+  inline size_t depth() const { return mQueue.read_available(); }
+
+  size_t batches() const { return mBatches.load(std::memory_order_relaxed); }
+  size_t popped() const { return mPopped.load(std::memory_order_relaxed); }
+
+private:
+  SPSCQueue<Item> mQueue;
+  alignas(CACHE_LINE_SIZE) std::atomic_bool mScheduled{false};
+  alignas(CACHE_LINE_SIZE) std::atomic_size_t mBatches{0};
+  std::atomic_size_t mPopped{0};
+};
+
+} // namespace hft::server
+
+#endif // HFT_SERVER_WORKERINBOX_HPP
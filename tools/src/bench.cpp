@@ -0,0 +1,413 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-22
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost_types.hpp"
+#include "logger.hpp"
+#include "market_types.hpp"
+#include "network/async_socket.hpp"
+#include "network_types.hpp"
+#include "order_book.hpp"
+#include "order_slab.hpp"
+#include "pool/buffer_pool.hpp"
+#include "rtt_tracker.hpp"
+#include "serialization/flat_buffers/fb_serializer.hpp"
+#include "ticker_index.hpp"
+#include "utils/rng.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/utils.hpp"
+
+namespace {
+
+using namespace hft;
+using namespace hft::server;
+using Serializer = serialization::FlatBuffersSerializer;
+
+constexpr Price MID_PRICE = 100000;
+constexpr uint32_t SEED = 42;
+constexpr size_t ORDERS_PER_LEVEL = 4;
+constexpr size_t FLOW_SIZE = 1 << 16;
+constexpr size_t SLAB_SIZE = 1 << 20;
+constexpr size_t STREAM_SIZE = 1 << 20;
+constexpr size_t POOL_BATCH = 16;
+
+/**
+ * @brief Book with depth levels of ORDERS_PER_LEVEL orders on each side of MID_PRICE.
+ * Flows only roughly balance what they add and take, so the book is built again
+ * outside of the timing once it grows past half of the slab
+ */
+class BookFixture {
+public:
+  explicit BookFixture(size_t depth) : mDepth{depth} { reset(); }
+
+  void reset() {
+    mBook.reset();
+    mSlab = std::make_unique<OrderSlab>(SLAB_SIZE);
+    mBook = std::make_unique<FlatOrderBook<OrderSlab>>();
+    mBook->adopt(*mSlab);
+    std::mt19937 rng{SEED};
+    OrderId id = 0;
+    for (size_t count = 0; count < ORDERS_PER_LEVEL; ++count) {
+      for (Price level = 1; level <= mDepth; ++level) {
+        const Quantity quantity = 1 + rng() % 10;
+        mBook->add(Order{0, ++id, {}, quantity, MID_PRICE - level, OrderAction::Buy});
+        mBook->add(Order{0, ++id, {}, quantity, MID_PRICE + level, OrderAction::Sell});
+      }
+    }
+  }
+
+  inline bool grown() const { return mSlab->occupancy() > SLAB_SIZE / 2; }
+  inline FlatOrderBook<OrderSlab> &book() { return *mBook; }
+
+private:
+  const size_t mDepth;
+  std::unique_ptr<OrderSlab> mSlab;
+  std::unique_ptr<FlatOrderBook<OrderSlab>> mBook;
+};
+
+/**
+ * @brief Passive order inside the existing depth, never crosses the other side
+ */
+Order passiveOrder(std::mt19937 &rng, size_t depth, OrderId id) {
+  const bool buy = rng() % 2 == 0;
+  const Price offset = 1 + rng() % depth;
+  const Quantity quantity = 1 + rng() % 10;
+  return Order{0, id, {}, quantity, buy ? MID_PRICE - offset : MID_PRICE + offset,
+               buy ? OrderAction::Buy : OrderAction::Sell};
+}
+
+/**
+ * @brief Resting adds at depth levels per side
+ */
+void BM_BookAdd(benchmark::State &state) {
+  const size_t depth = state.range(0);
+  std::mt19937 rng{SEED};
+  std::vector<Order> flow;
+  flow.reserve(FLOW_SIZE);
+  for (OrderId id = 0; flow.size() < FLOW_SIZE; ++id) {
+    flow.push_back(passiveOrder(rng, depth, id));
+  }
+  BookFixture fixture{depth};
+  size_t cursor = 0;
+  for (auto _ : state) {
+    if (fixture.grown()) [[unlikely]] {
+      state.PauseTiming();
+      fixture.reset();
+      state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(fixture.book().add(flow[cursor++ & (FLOW_SIZE - 1)]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Execute with cross percent of the flow being IOC orders priced through the whole
+ * depth and the rest passive refills. Aggressive sizes are scaled to take about what the
+ * passive share adds, so the depth holds while the cross rate changes
+ */
+void BM_BookMatch(benchmark::State &state) {
+  const size_t depth = state.range(0);
+  const size_t cross = state.range(1);
+  std::mt19937 rng{SEED};
+  std::vector<Order> flow;
+  flow.reserve(FLOW_SIZE);
+  const size_t aggressiveMean = cross == 0 ? 1 : std::max<size_t>(1, 11 * (100 - cross) / cross);
+  for (OrderId id = 0; flow.size() < FLOW_SIZE; ++id) {
+    if (rng() % 100 >= cross) {
+      flow.push_back(passiveOrder(rng, depth, id));
+      continue;
+    }
+    const bool buy = rng() % 2 == 0;
+    const Quantity quantity = 1 + rng() % aggressiveMean;
+    Order order{0, id, {}, quantity, buy ? MID_PRICE + static_cast<Price>(depth)
+                                         : MID_PRICE - static_cast<Price>(depth),
+                buy ? OrderAction::Buy : OrderAction::Sell};
+    order.tif = TimeInForce::Ioc;
+    flow.push_back(order);
+  }
+  BookFixture fixture{depth};
+  size_t cursor = 0;
+  size_t statuses = 0;
+  for (auto _ : state) {
+    if (fixture.grown()) [[unlikely]] {
+      state.PauseTiming();
+      fixture.reset();
+      state.ResumeTiming();
+    }
+    statuses += fixture.book().execute(flow[cursor++ & (FLOW_SIZE - 1)]).size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["statuses"] = benchmark::Counter(statuses, benchmark::Counter::kAvgIterations);
+}
+
+template <typename Message>
+Message makeMessage();
+
+template <>
+Order makeMessage<Order>() {
+  Order order{0, 42, utils::toTicker("AAPL"), 100, MID_PRICE, OrderAction::Buy};
+  order.display = 10;
+  return order;
+}
+
+template <>
+OrderStatus makeMessage<OrderStatus>() {
+  return OrderStatus{0, 42, utils::toTicker("AAPL"), 100, MID_PRICE, OrderState::Partial,
+                     OrderAction::Buy};
+}
+
+template <>
+TickerPrice makeMessage<TickerPrice>() {
+  return TickerPrice{utils::toTicker("AAPL"), MID_PRICE, MID_PRICE - 1, MID_PRICE + 1, 300, 200};
+}
+
+template <>
+LoginRequest makeMessage<LoginRequest>() {
+  return LoginRequest{7, 0x1234567890ABCDEF};
+}
+
+template <>
+LoginResponse makeMessage<LoginResponse>() {
+  return LoginResponse{7, 0x1234567890ABCDEF};
+}
+
+template <typename Message>
+void BM_Serialize(benchmark::State &state) {
+  const Message message = makeMessage<Message>();
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto buffer = Serializer::serialize(message);
+    bytes += buffer.size();
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+template <typename Message>
+void BM_Deserialize(benchmark::State &state) {
+  const auto buffer = Serializer::serialize(makeMessage<Message>());
+  for (auto _ : state) {
+    auto result = Serializer::template deserialize<Message>(buffer.data(), buffer.size());
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+/**
+ * @brief Framing and deserialization of a prebuilt stream of size prefixed messages,
+ * handed to the socket in reads of the given size the way TCP segments come in
+ */
+template <typename Message>
+void BM_Framing(benchmark::State &state) {
+  const size_t readSize = state.range(0);
+  const auto body = Serializer::serialize(makeMessage<Message>());
+  const boost::endian::little_int16_at bodySize = static_cast<MessageSize>(body.size());
+  const size_t frameSize = sizeof(bodySize) + body.size();
+  ByteBuffer stream;
+  stream.reserve(STREAM_SIZE);
+  while (stream.size() + frameSize <= STREAM_SIZE) {
+    const size_t offset = stream.size();
+    stream.resize(offset + frameSize);
+    std::memcpy(stream.data() + offset, &bodySize, sizeof(bodySize));
+    std::memcpy(stream.data() + offset + sizeof(bodySize), body.data(), body.size());
+  }
+
+  IoContext ctx;
+  size_t messages = 0;
+  AsyncSocket<TcpSocket, Message> socket{TcpSocket{ctx}, TraderId{1},
+                                         [&messages](const Message &) { ++messages; }};
+  size_t cursor = 0;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto space = socket.readSpace();
+    const size_t read = std::min({readSize, space.size(), stream.size() - cursor});
+    std::memcpy(space.data(), stream.data() + cursor, read);
+    socket.consume(read);
+    bytes += read;
+    cursor += read;
+    if (cursor == stream.size()) {
+      cursor = 0;
+    }
+  }
+  state.SetBytesProcessed(bytes);
+  state.counters["messages"] = benchmark::Counter(messages, benchmark::Counter::kIsRate);
+}
+
+/**
+ * @brief Batches acquired and released by the same thread, the thread cache path
+ */
+void BM_PoolLocal(benchmark::State &state) {
+  auto &pool = BufferPool::instance();
+  const size_t size = state.range(0);
+  std::array<uint8_t *, POOL_BATCH> blocks;
+  for (auto _ : state) {
+    for (auto &block : blocks) {
+      block = pool.acquire(size);
+    }
+    benchmark::DoNotOptimize(blocks.data());
+    for (auto *block : blocks) {
+      pool.release(block);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * POOL_BATCH);
+}
+
+std::array<std::atomic<uint8_t *>, 64> gHandoffSlots{};
+
+/**
+ * @brief Every thread swaps its fresh block with one parked by another thread and releases
+ * that one, so most blocks are freed on a foreign thread as buffers written by a worker
+ * and sent by the network thread are
+ */
+void BM_PoolHandoff(benchmark::State &state) {
+  auto &pool = BufferPool::instance();
+  const size_t size = state.range(0);
+  size_t slot = state.thread_index();
+  for (auto _ : state) {
+    uint8_t *parked = gHandoffSlots[slot].exchange(pool.acquire(size), std::memory_order_acq_rel);
+    pool.release(parked);
+    slot = (slot + 7) % gHandoffSlots.size();
+  }
+  for (auto &parked : gHandoffSlots) {
+    pool.release(parked.exchange(nullptr, std::memory_order_acq_rel));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LogRtt(benchmark::State &state) {
+  using Tracker = RttTracker<RoundTrip, std::chrono::microseconds, 50, 200>;
+  const TimestampRaw sent = utils::getLinuxTimestamp();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Tracker::logRtt(sent));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+std::vector<Ticker> makeTickers(size_t count) {
+  std::vector<Ticker> tickers(count);
+  for (auto &ticker : tickers) {
+    ticker = utils::generateTicker();
+  }
+  return tickers;
+}
+
+void BM_TickerHash(benchmark::State &state) {
+  const auto tickers = makeTickers(state.range(0));
+  size_t cursor = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TickerHash{}(tickers[cursor]));
+    cursor = cursor + 1 == tickers.size() ? 0 : cursor + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Ticker to id lookups through the hash map and through the perfect hash index
+ */
+void BM_TickerMapFind(benchmark::State &state) {
+  const auto tickers = makeTickers(state.range(0));
+  std::unordered_map<Ticker, TickerId, TickerHash> map;
+  for (size_t i = 0; i < tickers.size(); ++i) {
+    map.emplace(tickers[i], i);
+  }
+  size_t cursor = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(tickers[cursor]));
+    cursor = cursor + 1 == tickers.size() ? 0 : cursor + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TickerIndexFind(benchmark::State &state) {
+  const auto tickers = makeTickers(state.range(0));
+  std::vector<TickerPrice> universe(tickers.size());
+  for (size_t i = 0; i < tickers.size(); ++i) {
+    universe[i].ticker = tickers[i];
+  }
+  const TickerIndex index{universe};
+  size_t cursor = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.find(tickers[cursor]));
+    cursor = cursor + 1 == tickers.size() ? 0 : cursor + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BookAdd)->ArgName("depth")->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_BookMatch)
+    ->ArgNames({"depth", "cross"})
+    ->ArgsProduct({{1, 10, 100, 1000}, {0, 10, 50, 90}});
+
+BENCHMARK_TEMPLATE(BM_Serialize, Order);
+BENCHMARK_TEMPLATE(BM_Serialize, OrderStatus);
+BENCHMARK_TEMPLATE(BM_Serialize, TickerPrice);
+BENCHMARK_TEMPLATE(BM_Serialize, LoginRequest);
+BENCHMARK_TEMPLATE(BM_Serialize, LoginResponse);
+BENCHMARK_TEMPLATE(BM_Deserialize, Order);
+BENCHMARK_TEMPLATE(BM_Deserialize, OrderStatus);
+BENCHMARK_TEMPLATE(BM_Deserialize, TickerPrice);
+BENCHMARK_TEMPLATE(BM_Deserialize, LoginRequest);
+BENCHMARK_TEMPLATE(BM_Deserialize, LoginResponse);
+
+BENCHMARK_TEMPLATE(BM_Framing, Order)->ArgName("read")->Arg(64)->Arg(1460)->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Framing, OrderStatus)->ArgName("read")->Arg(64)->Arg(1460)->Arg(16384);
+
+BENCHMARK(BM_PoolLocal)->ArgName("size")->Arg(64)->Arg(1024);
+BENCHMARK(BM_PoolHandoff)
+    ->ArgName("size")
+    ->Arg(64)
+    ->Arg(1024)
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->UseRealTime();
+
+BENCHMARK(BM_LogRtt)->Threads(1)->Threads(4)->UseRealTime();
+
+BENCHMARK(BM_TickerHash)->ArgName("tickers")->Arg(64)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_TickerMapFind)->ArgName("tickers")->Arg(64)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_TickerIndexFind)->ArgName("tickers")->Arg(64)->Arg(1024)->Arg(8192);
+
+} // namespace
+
+/**
+ * @brief Microbenchmarks of the hot path components. Results also go to hft_bench.json
+ * unless --benchmark_out is given, runs are diffed with compare.py of google benchmark
+ * hft_bench [benchmark flags]
+ */
+int main(int argc, char *argv[]) {
+  std::vector<char *> args(argv, argv + argc);
+  std::string out = "--benchmark_out=hft_bench.json";
+  std::string format = "--benchmark_out_format=json";
+  const bool hasOut = std::any_of(args.begin() + 1, args.end(), [](const char *arg) {
+    return std::string_view{arg}.starts_with("--benchmark_out=");
+  });
+  if (!hasOut) {
+    args.push_back(out.data());
+    args.push_back(format.data());
+  }
+  int count = static_cast<int>(args.size());
+  // Tickers of the lookup benchmarks are the same on every run
+  utils::RNG::seed(SEED);
+  benchmark::Initialize(&count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
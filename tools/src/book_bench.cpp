@@ -0,0 +1,161 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-15
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+#include "market_types.hpp"
+#include "order_book.hpp"
+#include "order_slab.hpp"
+#include "utils/perf_counters.hpp"
+#include "utils/simd.hpp"
+
+namespace {
+
+using namespace hft;
+using namespace hft::server;
+
+constexpr Price MID_PRICE = 100000;
+constexpr uint32_t SEED = 42;
+
+struct BenchConfig {
+  size_t books;
+  size_t levels;
+  size_t ordersPerLevel;
+  size_t orders;
+};
+
+struct BenchOrder {
+  uint32_t book;
+  Order order;
+};
+
+/**
+ * @brief Stream of aggressive orders, each sweeping into the first levels of a random book
+ * and followed by a passive order that refills the consumed depth
+ */
+std::vector<BenchOrder> generateFlow(const BenchConfig &config) {
+  std::mt19937 rng{SEED};
+  std::vector<BenchOrder> flow;
+  flow.reserve(config.orders * 2);
+  for (OrderId id = 0; flow.size() < config.orders * 2;) {
+    const uint32_t book = rng() % config.books;
+    const bool buy = rng() % 2 == 0;
+    const auto action = buy ? OrderAction::Buy : OrderAction::Sell;
+    const Price sweep = 1 + rng() % 3;
+    const Quantity quantity = 1 + rng() % (10 * config.ordersPerLevel);
+    const Price aggressive = buy ? MID_PRICE + sweep : MID_PRICE - sweep;
+    flow.push_back({book, Order{book, ++id, {}, quantity, aggressive, action}});
+
+    const Price offset = 1 + rng() % config.levels;
+    const Price passive = buy ? MID_PRICE + offset : MID_PRICE - offset;
+    flow.push_back({book, Order{book, ++id, {}, quantity, passive,
+                                buy ? OrderAction::Sell : OrderAction::Buy}});
+  }
+  return flow;
+}
+
+template <typename Slab>
+void run(const char *layout, const BenchConfig &config, const std::vector<BenchOrder> &flow) {
+  const size_t depth = config.books * config.levels * config.ordersPerLevel * 2;
+  Slab slab{depth * 2 + flow.size()};
+  std::vector<FlatOrderBook<Slab>> books(config.books);
+  for (auto &book : books) {
+    book.adopt(slab);
+  }
+  // Levels are filled round robin over books, so queued orders of one level are spread
+  // over the slab the way they are after a while of trading
+  std::mt19937 rng{SEED};
+  OrderId id = 0;
+  for (size_t count = 0; count < config.ordersPerLevel; ++count) {
+    for (Price level = 1; level <= config.levels; ++level) {
+      for (uint32_t book = 0; book < config.books; ++book) {
+        const Quantity quantity = 1 + rng() % 10;
+        books[book].add(Order{book, ++id, {}, quantity, MID_PRICE - level, OrderAction::Buy});
+        books[book].add(Order{book, ++id, {}, quantity, MID_PRICE + level, OrderAction::Sell});
+      }
+    }
+  }
+
+  size_t fills = 0;
+  uint64_t closed = 0;
+  utils::PerfCounters counters;
+  const auto start = std::chrono::steady_clock::now();
+  counters.start();
+  for (auto &entry : flow) {
+    auto &book = books[entry.book];
+    fills += book.execute(entry.order, [&closed](const Order &order) {
+                  closed += order.traderId;
+                }).size();
+  }
+  counters.stop();
+  const auto elapsed = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start);
+
+  const double perOrder = 1.0 / flow.size();
+  std::cout << std::left << std::setw(8) << layout << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << elapsed.count() * perOrder;
+  for (auto event : {utils::PerfCounters::L1dReadMisses, utils::PerfCounters::LlcReadMisses}) {
+    if (counters.available(event)) {
+      std::cout << std::setw(18) << std::setprecision(2) << counters.value(event) * perOrder;
+    } else {
+      std::cout << std::setw(18) << "n/a";
+    }
+  }
+  if (counters.available(utils::PerfCounters::Cycles) &&
+      counters.available(utils::PerfCounters::Instructions)) {
+    std::cout << std::setw(8) << std::setprecision(2)
+              << double(counters.value(utils::PerfCounters::Instructions)) /
+                     counters.value(utils::PerfCounters::Cycles);
+  } else {
+    std::cout << std::setw(8) << "n/a";
+  }
+  std::cout << "  fills:" << fills << " resting:" << slab.occupancy() << " checksum:" << closed
+            << std::endl;
+}
+
+} // namespace
+
+/**
+ * @brief Matching on deep books with the packed order layout against the hot/cold split one
+ * hft_book_bench [books] [levels] [ordersPerLevel] [orders]
+ */
+int main(int argc, char *argv[]) {
+  BenchConfig config{512, 100, 20, 2000000};
+  try {
+    if (argc > 1) {
+      config.books = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+      config.levels = std::stoul(argv[2]);
+    }
+    if (argc > 3) {
+      config.ordersPerLevel = std::stoul(argv[3]);
+    }
+    if (argc > 4) {
+      config.orders = std::stoul(argv[4]);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Usage: " << argv[0] << " [books] [levels] [ordersPerLevel] [orders]"
+              << std::endl;
+    return 1;
+  }
+  std::cout << "Simd:" << utils::Simd::toString(utils::Simd::level()) << " Books:" << config.books
+            << " Levels:" << config.levels
+            << " OrdersPerLevel:" << config.ordersPerLevel << " Orders:" << config.orders * 2
+            << std::endl;
+  const auto flow = generateFlow(config);
+  std::cout << std::left << std::setw(8) << "layout" << std::right << std::setw(10) << "ns/order"
+            << std::setw(18) << "L1d-miss/order" << std::setw(18) << "LLC-miss/order"
+            << std::setw(8) << "IPC" << std::endl;
+  run<PackedOrderSlab>("packed", config, flow);
+  run<OrderSlab>("split", config, flow);
+  return 0;
+}
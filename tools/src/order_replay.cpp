@@ -0,0 +1,492 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-21
+ */
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost_types.hpp"
+#include "config/config.hpp"
+#include "config/config_reader.hpp"
+#include "logger.hpp"
+#include "market_types.hpp"
+#include "network/async_socket.hpp"
+#include "network_types.hpp"
+#include "order_book.hpp"
+#include "order_capture.hpp"
+#include "order_slab.hpp"
+#include "pool/buffer_pool.hpp"
+#include "ticker_index.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/utils.hpp"
+#include "worker_inbox.hpp"
+
+namespace {
+
+using namespace hft;
+using namespace hft::server;
+
+constexpr size_t MAX_REPORTED = 10;
+constexpr size_t SEND_CHUNK = 64;
+constexpr auto QUIET_PERIOD = std::chrono::milliseconds(500);
+constexpr auto LOGIN_SETTLE = std::chrono::milliseconds(100);
+
+struct Fill {
+  OrderId id;
+  Quantity quantity;
+  Price price;
+  OrderState state;
+
+  bool operator==(const Fill &other) const = default;
+};
+
+/**
+ * @brief Fills are compared per session and ticker, the only order both the matching
+ * and the status stream of a session keep
+ */
+using FillKey = uint64_t;
+using FillMap = std::map<FillKey, std::vector<Fill>>;
+
+FillKey fillKey(TraderId session, TickerRef ticker) {
+  uint32_t packed;
+  std::memcpy(&packed, ticker.data(), sizeof(packed));
+  return (static_cast<uint64_t>(session) << 32) | packed;
+}
+
+void addFill(FillMap &fills, TraderId session, const OrderStatus &status) {
+  fills[fillKey(session, status.ticker)].push_back(
+      Fill{status.id, status.quantity, status.fillPrice, status.state});
+}
+
+/**
+ * @brief Fills of a ticker may come from several workers if it migrated, so they are put
+ * in match order by their stamps
+ */
+FillMap capturedFills(const Capture &capture) {
+  std::map<FillKey, std::vector<const CaptureRecord *>> records;
+  for (auto &record : capture.records) {
+    if (record.type == CaptureRecord::Type::Fill) {
+      records[fillKey(record.session, record.fill().ticker)].push_back(&record);
+    }
+  }
+  FillMap fills;
+  for (auto &[key, stream] : records) {
+    std::stable_sort(stream.begin(), stream.end(),
+                     [](const CaptureRecord *left, const CaptureRecord *right) {
+                       return left->tsc < right->tsc;
+                     });
+    auto &sequence = fills[key];
+    for (auto *record : stream) {
+      const OrderStatus status = record->fill();
+      sequence.push_back(Fill{status.id, status.quantity, status.fillPrice, status.state});
+    }
+  }
+  return fills;
+}
+
+/**
+ * @brief Returns the number of session and ticker pairs whose fills differ
+ */
+size_t verify(const FillMap &expected, const FillMap &actual) {
+  size_t mismatched = 0;
+  auto report = [&mismatched](FillKey key, const std::string &what) {
+    if (mismatched++ < MAX_REPORTED) {
+      const uint32_t packed = key & 0xffffffff;
+      Ticker ticker;
+      std::memcpy(ticker.data(), &packed, sizeof(packed));
+      std::cout << "Session " << (key >> 32) << " " << utils::toStrView(ticker) << ": " << what
+                << std::endl;
+    }
+  };
+  for (auto &[key, fills] : expected) {
+    auto found = actual.find(key);
+    if (found == actual.end()) {
+      report(key, std::format("{} fills missing", fills.size()));
+      continue;
+    }
+    auto &replayed = found->second;
+    const auto diverged = std::mismatch(fills.begin(), fills.end(), replayed.begin(),
+                                        replayed.end());
+    if (diverged.first != fills.end() || diverged.second != replayed.end()) {
+      report(key, std::format("{} fills captured, {} replayed, first difference at {}",
+                              fills.size(), replayed.size(), diverged.first - fills.begin()));
+    }
+  }
+  for (auto &[key, fills] : actual) {
+    if (!expected.contains(key)) {
+      report(key, std::format("{} unexpected fills", fills.size()));
+    }
+  }
+  return mismatched;
+}
+
+/**
+ * @brief Spaces orders by their arrival stamps divided by speed, zero speed sends
+ * everything as soon as possible
+ */
+class Pacer {
+public:
+  Pacer(const Capture &capture, double speed, uint64_t firstTsc)
+      : mTscPerNs{capture.header.tscPerNs}, mSpeed{speed}, mFirstTsc{firstTsc} {}
+
+  void start() { mStart = std::chrono::steady_clock::now(); }
+
+  /**
+   * @brief Time left until the record is due, zero or negative once it is
+   */
+  std::chrono::nanoseconds wait(const CaptureRecord &record) const {
+    if (mSpeed == 0 || mTscPerNs == 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    const auto offset = std::chrono::nanoseconds(
+        static_cast<int64_t>((record.tsc - mFirstTsc) / mTscPerNs / mSpeed));
+    return mStart + offset - std::chrono::steady_clock::now();
+  }
+
+private:
+  const double mTscPerNs;
+  const double mSpeed;
+  const uint64_t mFirstTsc;
+  std::chrono::steady_clock::time_point mStart;
+};
+
+/**
+ * @brief Feeds routed orders straight into worker rings, one book per ticker owned by
+ * worker tickerId % workers. No network, no risk stage
+ */
+class EngineReplay {
+  using OrderBook = FlatOrderBook<OrderSlab>;
+
+  struct Worker {
+    Worker(size_t queueSize, size_t slabSize) : inbox{queueSize}, slab{slabSize} {}
+
+    WorkerInbox inbox;
+    OrderSlab slab;
+    FillMap fills;
+    std::thread thread;
+  };
+
+public:
+  EngineReplay(const Capture &capture, const std::vector<const CaptureRecord *> &orders)
+      : mCapture{capture}, mOrders{orders} {
+    std::vector<TickerPrice> tickers;
+    for (auto *record : orders) {
+      tickers.push_back(TickerPrice{record->order().ticker, 0});
+    }
+    std::sort(tickers.begin(), tickers.end(),
+              [](const TickerPrice &left, const TickerPrice &right) {
+                return left.ticker < right.ticker;
+              });
+    tickers.erase(std::unique(tickers.begin(), tickers.end(),
+                              [](const TickerPrice &left, const TickerPrice &right) {
+                                return left.ticker == right.ticker;
+                              }),
+                  tickers.end());
+    mIndex.build(tickers);
+    mBooks = std::vector<OrderBook>(mIndex.size());
+    for (size_t i = 0; i < Config::cfg.coreIds.size(); ++i) {
+      mWorkers.emplace_back(
+          std::make_unique<Worker>(Config::cfg.workerQueueSize, Config::cfg.orderSlabSize));
+    }
+    for (TickerId id = 0; id < mBooks.size(); ++id) {
+      mBooks[id].adopt(mWorkers[id % mWorkers.size()]->slab);
+      mBooks[id].setSelfTradePrevention(capture.header.selfTrade);
+    }
+  }
+
+  FillMap run(double speed) {
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+      mWorkers[i]->thread = std::thread([this, i]() {
+        utils::pinThreadToCore(Config::cfg.coreIds[i]);
+        match(*mWorkers[i]);
+      });
+    }
+    Pacer pacer{mCapture, speed, mOrders.empty() ? 0 : mOrders.front()->tsc};
+    pacer.start();
+    for (auto *record : mOrders) {
+      while (pacer.wait(*record).count() > 0) {
+        _mm_pause();
+      }
+      Order order = record->order();
+      order.traderId = record->session;
+      const TickerId tickerId = mIndex.find(order.ticker);
+      auto &inbox = mWorkers[tickerId % mWorkers.size()]->inbox;
+      while (!inbox.push(tickerId, order)) {
+        _mm_pause();
+      }
+    }
+    mDone.store(true, std::memory_order_release);
+    FillMap fills;
+    for (auto &worker : mWorkers) {
+      worker->thread.join();
+      fills.merge(worker->fills);
+    }
+    return fills;
+  }
+
+private:
+  void match(Worker &worker) {
+    const size_t batchSize = std::max<size_t>(Config::cfg.matchBatchSize, 1);
+    std::vector<WorkerInbox::Item> items(batchSize);
+    while (true) {
+      const size_t count = worker.inbox.pop(items.data(), batchSize);
+      for (size_t i = 0; i < count; ++i) {
+        for (auto &status : mBooks[items[i].tickerId].execute(items[i].order)) {
+          if (status.state == OrderState::Partial || status.state == OrderState::Full) {
+            addFill(worker.fills, status.traderId, status);
+          }
+        }
+      }
+      if (count == 0) {
+        if (mDone.load(std::memory_order_acquire) && worker.inbox.depth() == 0) {
+          break;
+        }
+        _mm_pause();
+      }
+    }
+  }
+
+private:
+  const Capture &mCapture;
+  const std::vector<const CaptureRecord *> &mOrders;
+  TickerIndex mIndex;
+  std::vector<OrderBook> mBooks;
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::atomic_bool mDone{false};
+};
+
+/**
+ * @brief Logs in one trader session per captured one and sends every captured order over
+ * its session. Server should run with the config of the capture and start with empty books.
+ * Orders of different sessions may interleave differently than captured at high speed
+ */
+class TcpReplay {
+  using StatusSocket = AsyncSocket<TcpSocket, OrderStatus>;
+  using OrderSocket = AsyncSocket<TcpSocket, LoginResponse>;
+
+  struct Connection {
+    TraderId captured{0};
+    TraderId traderId{0};
+    SessionToken token{0};
+    std::unique_ptr<OrderSocket> orders;
+    std::unique_ptr<StatusSocket> statuses;
+  };
+
+public:
+  TcpReplay(const Capture &capture, const std::vector<const CaptureRecord *> &orders)
+      : mCapture{capture}, mOrders{orders}, mTimer{mCtx} {
+    for (auto *record : orders) {
+      if (!mSessions.contains(record->session)) {
+        const size_t index = mConnections.size();
+        mSessions[record->session] = index;
+        auto &connection = *mConnections.emplace_back(std::make_unique<Connection>());
+        connection.captured = record->session;
+        connection.orders = std::make_unique<OrderSocket>(
+            TcpSocket{mCtx},
+            TcpEndpoint{Ip::make_address(Config::cfg.url), Config::cfg.portTcpIn},
+            [this, index](const LoginResponse &response) { onLoginResponse(index, response); });
+        connection.statuses = std::make_unique<StatusSocket>(
+            TcpSocket{mCtx},
+            TcpEndpoint{Ip::make_address(Config::cfg.url), Config::cfg.portTcpOut},
+            [this, index](const OrderStatus &status) { onStatus(index, status); });
+      }
+    }
+  }
+
+  FillMap run(double speed) {
+    mPacer = std::make_unique<Pacer>(mCapture, speed, mOrders.empty() ? 0 : mOrders.front()->tsc);
+    for (auto &connection : mConnections) {
+      connection->orders->asyncConnect([socket = connection->orders.get()]() {
+        socket->asyncRead();
+      });
+    }
+    mCtx.run();
+    return std::move(mFills);
+  }
+
+  size_t received() const { return mReceived; }
+
+private:
+  void onLoginResponse(size_t index, const LoginResponse &response) {
+    auto &connection = *mConnections[index];
+    connection.traderId = response.traderId;
+    connection.token = response.token;
+    connection.statuses->asyncConnect([this, index]() {
+      auto &connection = *mConnections[index];
+      LoginRequest request{connection.traderId, connection.token};
+      connection.statuses->asyncWrite(Span<LoginRequest>{&request, 1});
+      connection.statuses->asyncRead();
+      if (++mLoggedIn == mConnections.size()) {
+        // Server drops orders of a session until it has bound its status connection
+        mTimer.expires_after(LOGIN_SETTLE);
+        mTimer.async_wait([this](BoostErrorRef ec) {
+          if (!ec) {
+            mPacer->start();
+            sendDue();
+          }
+        });
+      }
+    });
+  }
+
+  void onStatus(size_t index, const OrderStatus &status) {
+    ++mReceived;
+    if (status.state == OrderState::Partial || status.state == OrderState::Full) {
+      addFill(mFills, mConnections[index]->captured, status);
+    }
+  }
+
+  /**
+   * @brief Sends what is due in chunks, so statuses are read in between
+   */
+  void sendDue() {
+    for (size_t sent = 0; mCursor < mOrders.size() && sent < SEND_CHUNK; ++sent) {
+      const auto &record = *mOrders[mCursor];
+      const auto wait = mPacer->wait(record);
+      if (wait > std::chrono::microseconds(50)) {
+        mTimer.expires_after(wait);
+        mTimer.async_wait([this](BoostErrorRef ec) {
+          if (!ec) {
+            sendDue();
+          }
+        });
+        return;
+      }
+      if (wait.count() > 0) {
+        break;
+      }
+      Order order = record.order();
+      mConnections[mSessions[record.session]]->orders->asyncWrite(Span<Order>{&order, 1});
+      ++mCursor;
+    }
+    if (mCursor < mOrders.size()) {
+      boost::asio::post(mCtx, [this]() { sendDue(); });
+    } else {
+      scheduleQuietCheck();
+    }
+  }
+
+  /**
+   * @brief Replay is over once no status came in for a whole period after the last order
+   */
+  void scheduleQuietCheck() {
+    mTimer.expires_after(QUIET_PERIOD);
+    mTimer.async_wait([this](BoostErrorRef ec) {
+      if (ec) {
+        return;
+      }
+      if (mReceived == mLastReceived) {
+        mCtx.stop();
+        return;
+      }
+      mLastReceived = mReceived;
+      scheduleQuietCheck();
+    });
+  }
+
+private:
+  const Capture &mCapture;
+  const std::vector<const CaptureRecord *> &mOrders;
+
+  IoContext mCtx;
+  SteadyTimer mTimer;
+  std::unique_ptr<Pacer> mPacer;
+
+  std::map<TraderId, size_t> mSessions;
+  std::vector<std::unique_ptr<Connection>> mConnections;
+  size_t mLoggedIn{0};
+  size_t mCursor{0};
+  size_t mReceived{0};
+  size_t mLastReceived{0};
+  FillMap mFills;
+};
+
+size_t countFills(const FillMap &fills) {
+  size_t count = 0;
+  for (auto &[key, sequence] : fills) {
+    count += sequence.size();
+  }
+  return count;
+}
+
+} // namespace
+
+/**
+ * @brief Replays a capture written by the server with [capture] path set and checks the fills
+ * hft_order_replay <capture> [speed] [engine|tcp]
+ * speed 1 keeps the captured pace, N replays N times faster, 0 or max as fast as possible.
+ * engine matches in process on the worker rings, tcp sends to a running server.
+ * Worker cores, queue and slab sizes and the server address come from server_config.ini
+ */
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <capture> [speed|max] [engine|tcp]" << std::endl;
+    return 1;
+  }
+  try {
+    const std::string speedArg = argc > 2 ? argv[2] : "1";
+    const double speed = speedArg == "max" ? 0 : std::stod(speedArg);
+    const std::string mode = argc > 3 ? argv[3] : "engine";
+    if (speed < 0 || (mode != "engine" && mode != "tcp")) {
+      std::cerr << "Usage: " << argv[0] << " <capture> [speed|max] [engine|tcp]" << std::endl;
+      return 1;
+    }
+    Logger::initialize(spdlog::level::err, "replay_log.txt");
+    ConfigReader::readConfig("server_config.ini");
+    BufferPool::configure(Config::cfg.poolArenaMb << 20, Config::cfg.poolHugePages);
+
+    const auto capture = Capture::read(argv[1]);
+    std::vector<const CaptureRecord *> orders;
+    for (auto &record : capture.records) {
+      // Engine takes only what reached the workers, the server decides again over tcp
+      if (record.type == CaptureRecord::Type::Order && (record.routed || mode == "tcp")) {
+        orders.push_back(&record);
+      }
+    }
+    const auto expected = capturedFills(capture);
+    std::cout << "Capture " << argv[1] << " records:" << capture.records.size()
+              << " orders:" << orders.size() << " fills:" << countFills(expected)
+              << " dropped:" << capture.header.dropped << std::endl;
+    if (capture.header.dropped != 0) {
+      std::cout << "Capture dropped records, fills are not expected to match" << std::endl;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    FillMap actual;
+    if (mode == "engine") {
+      actual = EngineReplay{capture, orders}.run(speed);
+    } else {
+      actual = TcpReplay{capture, orders}.run(speed);
+    }
+    const auto elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(3) << "Replayed " << orders.size()
+              << " orders over " << mode << " in " << elapsed << "s, "
+              << std::setprecision(0) << (elapsed == 0 ? 0 : orders.size() / elapsed)
+              << " orders/s, fills:" << countFills(actual) << std::endl;
+    const size_t mismatched = verify(expected, actual);
+    Logger::shutdown();
+    if (mismatched != 0) {
+      std::cout << "Fills differ for " << mismatched << " session tickers" << std::endl;
+      return 2;
+    }
+    std::cout << "Fills match" << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "Replay failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-16
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "utils/simd.hpp"
+
+namespace {
+
+using namespace hft::utils;
+
+constexpr size_t QUERIES = 1 << 16;
+constexpr size_t REPEATS = 32;
+constexpr uint32_t SEED = 42;
+
+/**
+ * @brief Average ns per call of kernel over the precomputed queries
+ */
+template <typename Kernel>
+double measure(const std::vector<uint32_t> &queries, Kernel &&kernel) {
+  uint64_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t repeat = 0; repeat < REPEATS; ++repeat) {
+    for (auto query : queries) {
+      checksum += kernel(query);
+    }
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start);
+  asm volatile("" : : "r"(checksum) : "memory");
+  return elapsed.count() / (queries.size() * REPEATS);
+}
+
+void run(Simd::Level level, size_t levels) {
+  std::mt19937 rng{SEED};
+  // Level prices of one side with gaps and volumes of the same size
+  std::vector<uint32_t> prices(levels);
+  std::vector<uint32_t> volumes(levels);
+  uint32_t price = 100000;
+  for (size_t i = 0; i < levels; ++i) {
+    price += 1 + rng() % 4;
+    prices[i] = price;
+    volumes[i] = 1 + rng() % 1000;
+  }
+
+  std::vector<uint32_t> queries(QUERIES);
+  for (auto &query : queries) {
+    query = rng() % levels;
+  }
+
+  const double search = measure(queries, [&](uint32_t query) {
+    return Simd::lowerBoundAscending(prices.data(), prices.size(), prices[query]);
+  });
+  const double sweep = measure(queries, [&](uint32_t query) {
+    return Simd::sum(volumes.data() + query, volumes.size() - query);
+  });
+  std::cout << std::left << std::setw(8) << Simd::toString(level) << std::right << std::setw(8)
+            << levels << std::fixed << std::setprecision(2) << std::setw(12) << search
+            << std::setw(12) << sweep << std::endl;
+}
+
+} // namespace
+
+/**
+ * @brief Book scan kernels at every instruction set level the cpu supports
+ * hft_simd_bench [levels...]
+ */
+int main(int argc, char *argv[]) {
+  std::vector<size_t> sizes{16, 64, 256, 1024, 4096};
+  if (argc > 1) {
+    sizes.clear();
+    for (int i = 1; i < argc; ++i) {
+      sizes.push_back(std::stoul(argv[i]));
+    }
+  }
+  std::cout << "Detected:" << Simd::toString(Simd::detect()) << " ns per call" << std::endl;
+  std::cout << std::left << std::setw(8) << "isa" << std::right << std::setw(8) << "levels"
+            << std::setw(12) << "search" << std::setw(12) << "sweep-sum" << std::endl;
+  for (auto level : {Simd::Level::Scalar, Simd::Level::Avx2, Simd::Level::Avx512}) {
+    if (Simd::setLevel(level) != level) {
+      continue;
+    }
+    for (auto size : sizes) {
+      run(level, std::max<size_t>(size, 1));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-12
+ */
+
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#include "db/postgres_adapter.hpp"
+#include "db/ticker_file.hpp"
+#include "market_types.hpp"
+#include "utils/utils.hpp"
+
+/**
+ * @brief Writes the binary ticker file for the file market data source
+ * hft_ticker_export <file>          exports the tickers table from Postgres
+ * hft_ticker_export <file> <count>  generates count random tickers instead
+ */
+int main(int argc, char *argv[]) {
+  using namespace hft;
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file> [count]" << std::endl;
+    return 1;
+  }
+  try {
+    std::vector<TickerPrice> tickers;
+    if (argc > 2) {
+      const size_t count = std::stoul(argv[2]);
+      if (count >= INVALID_TICKER_ID) {
+        std::cerr << "Ticker universe is limited to " << INVALID_TICKER_ID - 1 << std::endl;
+        return 1;
+      }
+      std::unordered_set<Ticker, TickerHash> unique;
+      tickers.reserve(count);
+      while (tickers.size() < count) {
+        auto tickerPrice = utils::generateTickerPrice();
+        if (unique.insert(tickerPrice.ticker).second) {
+          tickers.push_back(tickerPrice);
+        }
+      }
+    } else {
+      tickers = db::PostgresAdapter::readTickers();
+    }
+    db::TickerFile::write(argv[1], tickers);
+    std::cout << "Exported " << tickers.size() << " tickers to " << argv[1] << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << "Export failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -6,27 +6,52 @@
 #include "config/config.hpp"
 #include "config/config_reader.hpp"
 #include "logger.hpp"
+#include "strategy.hpp"
 #include "trader.hpp"
+#include "utils/rng.hpp"
 #include "utils/string_utils.hpp"
 
+namespace {
+
+template <typename Strategy>
+void runTrader() {
+  hft::trader::Trader<Strategy> trader;
+  trader.start();
+}
+
+} // namespace
+
 int main(int argc, char *argv[]) {
   using namespace hft;
-  std::unique_ptr<trader::Trader> trader;
   try {
-    Logger::initialize(spdlog::level::err, "trader_log.txt");
+    Logger::initialize(spdlog::level::err, "trader_log.txt", Logger::Backend::Binary);
     ConfigReader::readConfig("trader_config.ini");
+    Config::cfg.rngSeed = utils::RNG::seed(Config::cfg.rngSeed);
 
     Logger::monitorLogger->info("Trader configuration:");
     Config::cfg.logConfig();
+    BufferPool::configure(Config::cfg.poolArenaMb << 20, Config::cfg.poolHugePages);
     Logger::monitorLogger->info("LogLevel:{}", utils::toString(spdlog::get_level()));
 
-    trader = std::make_unique<trader::Trader>();
-    trader->start();
+    switch (trader::parseStrategy(Config::cfg.strategy)) {
+    case trader::StrategyType::MarketMaking:
+      runTrader<trader::MarketMaker>();
+      break;
+    case trader::StrategyType::Momentum:
+      runTrader<trader::Momentum>();
+      break;
+    case trader::StrategyType::Replay:
+      runTrader<trader::Replay>();
+      break;
+    default:
+      runTrader<trader::RandomStrategy>();
+      break;
+    }
   } catch (const std::exception &e) {
     Logger::monitorLogger->critical("Exception caught in main {}", e.what());
     spdlog::critical("Exception caught in main {}", e.what());
     spdlog::default_logger()->flush();
-    trader->stop();
   }
+  Logger::shutdown();
   return 0;
-}
\ No newline at end of file
+}
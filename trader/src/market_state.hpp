@@ -0,0 +1,86 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-19
+ */
+
+#ifndef HFT_TRADER_MARKETSTATE_HPP
+#define HFT_TRADER_MARKETSTATE_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "market_types.hpp"
+#include "ticker_index.hpp"
+#include "types.hpp"
+#include "utils/seqlock.hpp"
+
+namespace hft::trader {
+
+/**
+ * @brief Mirror of the server price feed, one slot per ticker by dense index.
+ * Feed threads write quotes in place, sessions read them from their own threads
+ * without locking, a read racing a write just retries. Only the top of book is mirrored,
+ * the feed publishes no depth below the best levels
+ */
+class MarketState {
+  struct alignas(32) Slot {
+    utils::SeqLock<TickerPrice> quote;
+  };
+
+public:
+  explicit MarketState(const std::vector<TickerPrice> &prices)
+      : mIndex{prices}, mSlots(mIndex.size()) {
+    for (auto &tickerPrice : prices) {
+      mSlots[mIndex.find(tickerPrice.ticker)].quote.store(tickerPrice);
+    }
+  }
+
+  MarketState(const MarketState &) = delete;
+  MarketState &operator=(const MarketState &) = delete;
+
+  /**
+   * @brief Returns the ticker index, INVALID_TICKER_ID for a ticker outside the universe.
+   * In tick mode every worker writes the same update, counters are then per copy
+   */
+  TickerId update(const TickerPrice &quote) {
+    const TickerId tickerId = mIndex.find(quote.ticker);
+    if (tickerId == INVALID_TICKER_ID) [[unlikely]] {
+      mUnknown.fetch_add(1, std::memory_order_relaxed);
+      return tickerId;
+    }
+    mSlots[tickerId].quote.store(quote);
+    mUpdates.fetch_add(1, std::memory_order_relaxed);
+    return tickerId;
+  }
+
+  inline TickerPrice quote(TickerId tickerId) const { return mSlots[tickerId].quote.load(); }
+
+  /**
+   * @brief Middle of the best levels, last price while a side is empty
+   */
+  inline Price reference(TickerId tickerId) const {
+    const TickerPrice quote = this->quote(tickerId);
+    if (quote.bid != 0 && quote.ask != 0) {
+      return quote.bid + (quote.ask - quote.bid) / 2;
+    }
+    return quote.price;
+  }
+
+  inline TickerId find(TickerRef ticker) const { return mIndex.find(ticker); }
+  inline TickerRef ticker(TickerId tickerId) const { return mIndex.ticker(tickerId); }
+  inline size_t size() const { return mIndex.size(); }
+
+  size_t updates() const { return mUpdates.load(std::memory_order_relaxed); }
+  size_t unknown() const { return mUnknown.load(std::memory_order_relaxed); }
+
+private:
+  const TickerIndex mIndex;
+  std::vector<Slot> mSlots;
+
+  std::atomic_size_t mUpdates{0};
+  std::atomic_size_t mUnknown{0};
+};
+
+} // namespace hft::trader
+
+#endif // HFT_TRADER_MARKETSTATE_HPP
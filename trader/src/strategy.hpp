@@ -0,0 +1,331 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-20
+ */
+
+#ifndef HFT_TRADER_STRATEGY_HPP
+#define HFT_TRADER_STRATEGY_HPP
+
+#include <array>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "config/config.hpp"
+#include "market_state.hpp"
+#include "market_types.hpp"
+#include "types.hpp"
+#include "utils/rng.hpp"
+#include "utils/string_utils.hpp"
+
+namespace hft::trader {
+
+/**
+ * @brief Built in strategies, picked by [strategy] name. Strategies are policies of the session
+ * and trader templates, so their calls inline into the socket and timer handlers. Each one is
+ * built from the market state and the own tickers of its session and provides
+ *   bool onTimer(TickerId, Order &)    trade slot of the timer mode, ticker picked by session
+ *   bool onTick(TickerId, Order &)     price update of an own ticker in tick mode
+ *   void onStatus(const OrderStatus &)
+ * Order is placed when true is returned, the session sets its id
+ */
+enum class StrategyType : uint8_t { Random, MarketMaking, Momentum, Replay };
+
+inline StrategyType parseStrategy(const std::string &name) {
+  if (name == "random") {
+    return StrategyType::Random;
+  }
+  if (name == "market_making") {
+    return StrategyType::MarketMaking;
+  }
+  if (name == "momentum") {
+    return StrategyType::Momentum;
+  }
+  if (name == "replay") {
+    return StrategyType::Replay;
+  }
+  throw std::runtime_error(std::format("Unknown strategy {}", name));
+}
+
+/**
+ * @brief Fill of an own order either way, taking or resting. Partial with Cancelled is
+ * quantity removed by self trade prevention, not a fill
+ */
+inline bool isFill(const OrderStatus &status) {
+  constexpr auto FILLED = static_cast<uint8_t>(OrderState::Partial) |
+                          static_cast<uint8_t>(OrderState::Full);
+  const auto state = static_cast<uint8_t>(status.state);
+  return (state & FILLED) != 0 && (state & static_cast<uint8_t>(OrderState::Cancelled)) == 0;
+}
+
+/**
+ * @brief Random side and quantity, price anywhere up to twice the reference,
+ * with a share of every order type. Raw values come in bulk from the thread generator
+ * and are scaled per field, so an order costs a few multiplies
+ */
+class RandomStrategy {
+public:
+  RandomStrategy(const MarketState &market, const std::vector<TickerId> &tickers)
+      : mMarket{market} {}
+
+  inline bool onTimer(TickerId tickerId, Order &order) { return makeOrder(tickerId, order); }
+  inline bool onTick(TickerId tickerId, Order &order) { return makeOrder(tickerId, order); }
+  inline void onStatus(const OrderStatus &status) {}
+
+private:
+  bool makeOrder(TickerId tickerId, Order &order) {
+    const Price reference = mMarket.reference(tickerId);
+    order.ticker = mMarket.ticker(tickerId);
+    order.price = draw(reference * 2 + 1);
+    order.action = draw(2) == 0 ? OrderAction::Buy : OrderAction::Sell;
+    order.quantity = draw(1001);
+    // Mostly plain limit orders with a share of every other type
+    switch (draw(20)) {
+    case 0:
+      order.tif = TimeInForce::Ioc;
+      break;
+    case 1:
+      order.tif = TimeInForce::Fok;
+      break;
+    case 2:
+      order.type = OrderType::Market;
+      order.price = 0;
+      break;
+    case 3:
+      order.type = OrderType::PostOnly;
+      break;
+    case 4:
+      order.display = order.quantity / 10 + 1;
+      break;
+    case 5:
+      order.type = OrderType::Stop;
+      order.trigger = draw(reference * 2 + 1);
+      break;
+    case 6:
+      order.type = OrderType::StopLimit;
+      order.trigger = draw(reference * 2 + 1);
+      break;
+    default:
+      break;
+    }
+    return true;
+  }
+
+  inline uint32_t draw(uint32_t range) {
+    if (mDrawn == DRAWS) [[unlikely]] {
+      utils::RNG::fill(mDraws.data(), DRAWS);
+      mDrawn = 0;
+    }
+    return utils::RNG::scale(mDraws[mDrawn++], range);
+  }
+
+private:
+  static constexpr size_t DRAWS = 256;
+
+  const MarketState &mMarket;
+
+  std::array<uint32_t, DRAWS> mDraws;
+  size_t mDrawn{DRAWS};
+};
+
+/**
+ * @brief Post only quotes around the mirrored top of book, sides alternate per ticker.
+ * Improves the best level by a tick while the spread allows it and joins it otherwise,
+ * an empty side is quoted spread away from the reference, never through the other side.
+ * Once the position in a ticker reaches the limit only the side reducing it is quoted
+ */
+class MarketMaker {
+public:
+  MarketMaker(const MarketState &market, const std::vector<TickerId> &tickers)
+      : mMarket{market}, mSize{Config::cfg.quoteSize}, mSpread{Config::cfg.quoteSpread},
+        mMaxPosition{Config::cfg.maxPosition}, mPositions(market.size(), 0),
+        mSides(market.size(), OrderAction::Sell) {}
+
+  inline bool onTimer(TickerId tickerId, Order &order) { return quote(tickerId, order); }
+  inline bool onTick(TickerId tickerId, Order &order) { return quote(tickerId, order); }
+
+  void onStatus(const OrderStatus &status) {
+    if (!isFill(status)) {
+      return;
+    }
+    const TickerId tickerId = mMarket.find(status.ticker);
+    if (tickerId == INVALID_TICKER_ID) {
+      return;
+    }
+    const int64_t quantity = status.quantity;
+    mPositions[tickerId] += status.action == OrderAction::Buy ? quantity : -quantity;
+  }
+
+private:
+  bool quote(TickerId tickerId, Order &order) {
+    const TickerPrice top = mMarket.quote(tickerId);
+    const Price reference = mMarket.reference(tickerId);
+    if (reference == 0) {
+      return false;
+    }
+    OrderAction &side = mSides[tickerId];
+    side = side == OrderAction::Buy ? OrderAction::Sell : OrderAction::Buy;
+    if (mMaxPosition != 0) {
+      const int64_t position = mPositions[tickerId];
+      if (position >= mMaxPosition) {
+        side = OrderAction::Sell;
+      } else if (position <= -static_cast<int64_t>(mMaxPosition)) {
+        side = OrderAction::Buy;
+      }
+    }
+    const bool improve = top.bid != 0 && top.ask != 0 && top.ask - top.bid > 2;
+    order.ticker = mMarket.ticker(tickerId);
+    order.action = side;
+    order.quantity = mSize;
+    order.type = OrderType::PostOnly;
+    if (side == OrderAction::Buy) {
+      order.price = top.bid != 0 ? top.bid + (improve ? 1 : 0)
+                                 : (reference > mSpread ? reference - mSpread : 1);
+      if (top.ask != 0 && order.price >= top.ask) {
+        order.price = top.ask > 1 ? top.ask - 1 : 1;
+      }
+    } else {
+      order.price = top.ask != 0 ? top.ask - (improve ? 1 : 0) : reference + mSpread;
+      if (top.bid != 0 && order.price <= top.bid) {
+        order.price = top.bid + 1;
+      }
+    }
+    return true;
+  }
+
+private:
+  const MarketState &mMarket;
+  const Quantity mSize;
+  const Price mSpread;
+  const int64_t mMaxPosition;
+
+  std::vector<int64_t> mPositions;
+  std::vector<OrderAction> mSides;
+};
+
+/**
+ * @brief Follows the reference price. A move of at least momentum_bp since the previous look
+ * at a ticker takes the opposite best level with an IOC order in the direction of the move
+ */
+class Momentum {
+public:
+  Momentum(const MarketState &market, const std::vector<TickerId> &tickers)
+      : mMarket{market}, mSize{Config::cfg.quoteSize}, mThresholdBp{Config::cfg.momentumBp},
+        mLast(market.size(), 0) {}
+
+  inline bool onTimer(TickerId tickerId, Order &order) { return follow(tickerId, order); }
+  inline bool onTick(TickerId tickerId, Order &order) { return follow(tickerId, order); }
+  inline void onStatus(const OrderStatus &status) {}
+
+private:
+  bool follow(TickerId tickerId, Order &order) {
+    const TickerPrice top = mMarket.quote(tickerId);
+    const Price reference = mMarket.reference(tickerId);
+    const Price last = mLast[tickerId];
+    mLast[tickerId] = reference;
+    if (last == 0 || reference == 0 || reference == last) {
+      return false;
+    }
+    const uint64_t move = reference > last ? reference - last : last - reference;
+    if (move * 10000 < static_cast<uint64_t>(mThresholdBp) * last) {
+      return false;
+    }
+    order.ticker = mMarket.ticker(tickerId);
+    order.quantity = mSize;
+    order.tif = TimeInForce::Ioc;
+    if (reference > last) {
+      order.action = OrderAction::Buy;
+      order.price = top.ask != 0 ? top.ask : reference;
+    } else {
+      order.action = OrderAction::Sell;
+      order.price = top.bid != 0 ? top.bid : reference;
+    }
+    return true;
+  }
+
+private:
+  const MarketState &mMarket;
+  const Quantity mSize;
+  const uint32_t mThresholdBp;
+
+  std::vector<Price> mLast;
+};
+
+/**
+ * @brief Plays orders from replay_file in a loop, one per timer slot or price update.
+ * Lines are ticker,side,quantity,price with side B or S, a zero price sends a market order.
+ * Session keeps only the lines of its own tickers, so sessions split the script the same
+ * way they split the universe
+ */
+class Replay {
+public:
+  Replay(const MarketState &market, const std::vector<TickerId> &tickers) {
+    std::vector<bool> own(market.size(), false);
+    for (TickerId tickerId : tickers) {
+      own[tickerId] = true;
+    }
+    std::ifstream file(Config::cfg.replayFile);
+    if (!file.is_open()) {
+      throw std::runtime_error(std::format("Failed to open {}", Config::cfg.replayFile));
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+      ++lineNumber;
+      if (line.empty() || line.front() == '#') {
+        continue;
+      }
+      Order order = parse(line, lineNumber);
+      const TickerId tickerId = market.find(order.ticker);
+      if (tickerId != INVALID_TICKER_ID && own[tickerId]) {
+        mOrders.push_back(order);
+      }
+    }
+  }
+
+  inline bool onTimer(TickerId tickerId, Order &order) { return next(order); }
+  inline bool onTick(TickerId tickerId, Order &order) { return next(order); }
+  inline void onStatus(const OrderStatus &status) {}
+
+private:
+  inline bool next(Order &order) {
+    if (mOrders.empty()) {
+      return false;
+    }
+    if (mCursor == mOrders.size()) {
+      mCursor = 0;
+    }
+    order = mOrders[mCursor++];
+    return true;
+  }
+
+  static Order parse(const std::string &line, size_t lineNumber) {
+    std::stringstream ss(line);
+    std::string ticker, side, quantity, price;
+    if (!std::getline(ss, ticker, ',') || !std::getline(ss, side, ',') ||
+        !std::getline(ss, quantity, ',') || !std::getline(ss, price) ||
+        (side != "B" && side != "S")) {
+      throw std::runtime_error(std::format("Invalid replay line {}: {}", lineNumber, line));
+    }
+    Order order;
+    order.ticker = utils::toTicker(ticker);
+    order.action = side == "B" ? OrderAction::Buy : OrderAction::Sell;
+    order.quantity = std::stoul(quantity);
+    order.price = std::stoul(price);
+    if (order.price == 0) {
+      order.type = OrderType::Market;
+    }
+    return order;
+  }
+
+private:
+  std::vector<Order> mOrders;
+  size_t mCursor{0};
+};
+
+} // namespace hft::trader
+
+#endif // HFT_TRADER_STRATEGY_HPP
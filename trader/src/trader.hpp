@@ -15,86 +15,187 @@
 #include "boost_types.hpp"
 #include "comparators.hpp"
 #include "config/config.hpp"
-#include "db/postgres_adapter.hpp"
+#include "db/ticker_provider.hpp"
+#include "market_state.hpp"
 #include "market_types.hpp"
 #include "network/async_socket.hpp"
 #include "network_types.hpp"
-#include "rtt_tracker.hpp"
 #include "template_types.hpp"
+#include "trader_session.hpp"
 #include "types.hpp"
 #include "utils/rng.hpp"
 #include "utils/utils.hpp"
 
 namespace hft::trader {
 
+/**
+ * @brief Load generator. Runs Config::cfg.sessionCount sessions spread round-robin
+ * over one io_context per configured core, prices and console input stay on the main context.
+ * Price feed is mirrored into the market state sessions read their prices from. In tick mode
+ * every worker reads the feed itself and hands updates to its sessions on the same thread.
+ * Templated on the strategy so the whole event loop is built for one of them
+ */
+template <typename Strategy>
 class Trader {
-  using TraderTcpSocket = AsyncSocket<TcpSocket, OrderStatus>;
   using TraderUdpSocket = AsyncSocket<UdpSocket, TickerPrice>;
-  using Tracker = RttTracker<50, 200>;
+  using Session = TraderSession<Strategy>;
+
+  struct TickerSession {
+    Session *session{nullptr};
+    ThreadId workerId{0};
+  };
 
 public:
   Trader()
       : mGuard{boost::asio::make_work_guard(mCtx)},
-        mIngressSocket{TcpSocket{mCtx},
-                       TcpEndpoint{Ip::make_address(Config::cfg.url), Config::cfg.portTcpOut},
-                       [this](const OrderStatus &status) { onOrderStatus(status); }},
-        mEgressSocket{TcpSocket{mCtx},
-                      TcpEndpoint{Ip::make_address(Config::cfg.url), Config::cfg.portTcpIn}},
-        mPricesSocket{createUdpSocket(), UdpEndpoint(Udp::v4(), Config::cfg.portUdp),
+        mPricesSocket{createUdpSocket(mCtx), UdpEndpoint(Udp::v4(), Config::cfg.portUdp),
                       [this](const TickerPrice &priceUpdate) { onPriceUpdate(priceUpdate); }},
-        mPrices{db::PostgresAdapter::readTickers()}, mTradeTimer{mCtx}, mMonitorTimer{mCtx},
-        mInputTimer{mCtx}, mTradeRate{Config::cfg.tradeRateUs},
+        mMonitorTimer{mCtx}, mInputTimer{mCtx}, mTradeRate{Config::cfg.tradeRateUs},
         mMonitorRate{Config::cfg.monitorRateS} {
+    if (Config::cfg.coreIds.size() == 0 || Config::cfg.sessionCount == 0) {
+      throw std::runtime_error("Invalid sessions configuration");
+    }
     fcntl(STDIN_FILENO, F_SETFL, O_NONBLOCK);
     std::cout << std::unitbuf;
 
-    mIngressSocket.asyncConnect([this]() {
-      Logger::monitorLogger->info("Ingress socket connected");
-      mIngressSocket.asyncRead();
-    });
-    mEgressSocket.asyncConnect(
-        [this]() { Logger::monitorLogger->info("Egress socket connected"); });
-    mPricesSocket.asyncConnect();
+    auto prices = db::TickerProvider::create()->readTickers();
+    Logger::monitorLogger->info(std::format("Market data loaded for {} tickers", prices.size()));
+    mMarket = std::make_unique<MarketState>(prices);
 
-    Logger::monitorLogger->info(std::format("Market data loaded for {} tickers", mPrices.size()));
+    startWorkers();
+    createSessions(prices);
+    if (Config::cfg.tradeMode == "tick") {
+      startTickFeeds();
+    } else {
+      mPricesSocket.asyncConnect();
+    }
     scheduleInputTimer();
   }
+  ~Trader() {
+    for (auto &ctx : mWorkerContexts) {
+      ctx->stop();
+    }
+    for (auto &thread : mWorkerThreads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
 
   void start() {
     utils::setTheadRealTime();
     mCtx.run();
   }
-  void stop() { mCtx.stop(); }
+  void stop() {
+    mCtx.stop();
+    for (auto &ctx : mWorkerContexts) {
+      ctx->stop();
+    }
+  }
 
 private:
-  void onOrderStatus(const OrderStatus &status) {
-    spdlog::debug("OrderStatus {}", [&status] { return utils::toString(status); }());
-    Tracker::logRtt(status.id);
+  void startWorkers() {
+    const size_t workers = Config::cfg.coreIds.size();
+    mWorkerContexts.reserve(workers);
+    mWorkerGuards.reserve(workers);
+    for (int i = 0; i < workers; ++i) {
+      mWorkerContexts.emplace_back(std::make_unique<IoContext>());
+      mWorkerGuards.emplace_back(
+          std::make_unique<ContextGuard>(boost::asio::make_work_guard(*mWorkerContexts.back())));
+      mWorkerThreads.emplace_back([this, i]() {
+        try {
+          utils::setTheadRealTime();
+          utils::pinThreadToCore(Config::cfg.coreIds[i]);
+          utils::RNG::seedThread(i + 1);
+          mWorkerContexts[i]->run();
+        } catch (const std::exception &e) {
+          Logger::monitorLogger->error("Exception in worker thread {}", e.what());
+        }
+      });
+    }
+  }
+
+  /**
+   * @brief Session i gets every sessionCount-th ticker starting from i, and lives on
+   * worker i % workers. Connecting is posted so each session only ever runs on its own worker
+   */
+  void createSessions(const std::vector<TickerPrice> &prices) {
+    const size_t sessions = Config::cfg.sessionCount;
+    const size_t hotCount = std::min<size_t>(Config::cfg.hotTickers, prices.size());
+    std::vector<TickerId> hotTickers;
+    for (size_t j = 0; j < hotCount; ++j) {
+      hotTickers.push_back(mMarket->find(prices[j].ticker));
+    }
+    mSessions.resize(sessions);
+    mTickerSessions.resize(mMarket->size());
+    for (size_t i = 0; i < sessions; ++i) {
+      std::vector<TickerId> subset;
+      subset.reserve(prices.size() / sessions + 1);
+      for (size_t j = i; j < prices.size(); j += sessions) {
+        subset.push_back(mMarket->find(prices[j].ticker));
+      }
+      const ThreadId workerId = i % mWorkerContexts.size();
+      auto &ctx = *mWorkerContexts[workerId];
+      mSessions[i] = std::make_unique<Session>(ctx, *mMarket, subset, hotTickers);
+      for (TickerId tickerId : subset) {
+        mTickerSessions[tickerId] = {mSessions[i].get(), workerId};
+      }
+      boost::asio::post(ctx, [session = mSessions[i].get()]() { session->connect(); });
+    }
+  }
+
+  template <typename Action>
+  void forEachSession(Action action) {
+    for (size_t i = 0; i < mSessions.size(); ++i) {
+      auto &ctx = *mWorkerContexts[i % mWorkerContexts.size()];
+      boost::asio::post(ctx, [session = mSessions[i].get(), action]() { action(*session); });
+    }
   }
 
   void onPriceUpdate(const TickerPrice &price) {
-    spdlog::debug([&price] { return utils::toString(price); }());
+    HFT_LOG_DEBUG("{}", price);
+    mMarket->update(price);
+  }
+
+  /**
+   * @brief Feed broadcasts reach every socket bound to the port, so each worker gets its
+   * own copy and only the owner session of a ticker reacts
+   */
+  void startTickFeeds() {
+    for (ThreadId id = 0; id < mWorkerContexts.size(); ++id) {
+      auto &ctx = *mWorkerContexts[id];
+      auto &socket = mTickSockets.emplace_back(std::make_unique<TraderUdpSocket>(
+          createUdpSocket(ctx), UdpEndpoint(Udp::v4(), Config::cfg.portUdp),
+          [this, id](const TickerPrice &price) { onTick(id, price); }));
+      boost::asio::post(ctx, [feed = socket.get()]() { feed->asyncConnect(); });
+    }
+  }
+
+  void onTick(ThreadId workerId, const TickerPrice &price) {
+    const TickerId tickerId = mMarket->update(price);
+    if (tickerId == INVALID_TICKER_ID) {
+      return;
+    }
+    auto &owner = mTickerSessions[tickerId];
+    if (owner.session != nullptr && owner.workerId == workerId) {
+      owner.session->onTick(tickerId, mTickSockets[workerId]->readTime());
+    }
   }
 
   void tradeStart() {
-    scheduleTradeTimer();
+    forEachSession([](Session &session) { session.tradeStart(); });
     scheduleMonitorTimer();
   }
 
   void tradeStop() {
-    mTradeTimer.cancel();
+    forEachSession([](Session &session) { session.tradeStop(); });
     mMonitorTimer.cancel();
   }
 
-  void scheduleTradeTimer() {
-    mTradeTimer.expires_after(mTradeRate);
-    mTradeTimer.async_wait([this](BoostErrorRef ec) {
-      if (ec) {
-        return;
-      }
-      tradeSomething();
-      scheduleTradeTimer();
-    });
+  void setTradeRate(Microseconds rate) {
+    mTradeRate = rate;
+    forEachSession([rate](Session &session) { session.setTradeRate(rate); });
+    Logger::monitorLogger->info(std::format("Trade rate: {}", mTradeRate));
   }
 
   void scheduleMonitorTimer() {
@@ -104,6 +205,11 @@ private:
         return;
       }
       Tracker::printStats();
+      DecideTracker::printStats();
+      SendTracker::printStats();
+      AckTracker::printStats();
+      Logger::monitorLogger->info("Prices [updates|unknown] {} {}", mMarket->updates(),
+                                  mMarket->unknown());
       scheduleMonitorTimer();
     });
   }
@@ -119,22 +225,6 @@ private:
     });
   }
 
-  void tradeSomething() {
-    static auto cursor = mPrices.begin();
-    if (cursor == mPrices.end()) {
-      cursor = mPrices.begin();
-    }
-    auto tickerPrice = *cursor++;
-    Order order;
-    order.id = utils::getLinuxTimestamp();
-    order.ticker = tickerPrice.ticker;
-    order.price = utils::RNG::rng<uint32_t>(tickerPrice.price * 2);
-    order.action = utils::RNG::rng(1) == 0 ? OrderAction::Buy : OrderAction::Sell;
-    order.quantity = utils::RNG::rng(1000);
-    spdlog::trace("Placing order {}", [&order] { return utils::toString(order); }());
-    mEgressSocket.asyncWrite(Span<Order>{&order, 1});
-  }
-
   void checkInput() {
     struct pollfd fds = {STDIN_FILENO, POLLIN, 0};
     if (poll(&fds, 1, 0) == 1) {
@@ -147,17 +237,15 @@ private:
       } else if (cmd == "t-") {
         tradeStop();
       } else if (cmd == "ts-") {
-        mTradeRate *= 2;
-        Logger::monitorLogger->info(std::format("Trade rate: {}", mTradeRate));
+        setTradeRate(mTradeRate * 2);
       } else if (cmd == "ts+" && mTradeRate > Microseconds(10)) {
-        mTradeRate /= 2;
-        Logger::monitorLogger->info(std::format("Trade rate: {}", mTradeRate));
+        setTradeRate(mTradeRate / 2);
       }
     }
   }
 
-  UdpSocket createUdpSocket() {
-    UdpSocket socket(mCtx, Udp::v4());
+  UdpSocket createUdpSocket(IoContext &ctx) {
+    UdpSocket socket(ctx, Udp::v4());
     socket.set_option(boost::asio::socket_base::reuse_address{true});
     socket.bind(UdpEndpoint(Udp::v4(), Config::cfg.portUdp));
     return socket;
@@ -167,12 +255,17 @@ private:
   IoContext mCtx;
   ContextGuard mGuard;
 
-  TraderTcpSocket mIngressSocket;
-  TraderTcpSocket mEgressSocket;
   TraderUdpSocket mPricesSocket;
+  std::unique_ptr<MarketState> mMarket;
+
+  std::vector<UPtrIoContext> mWorkerContexts;
+  std::vector<UPtrContextGuard> mWorkerGuards;
+  std::vector<std::thread> mWorkerThreads;
+
+  std::vector<typename Session::UPtr> mSessions;
+  std::vector<TickerSession> mTickerSessions;
+  std::vector<std::unique_ptr<TraderUdpSocket>> mTickSockets;
 
-  std::vector<TickerPrice> mPrices;
-  SteadyTimer mTradeTimer;
   SteadyTimer mMonitorTimer;
   SteadyTimer mInputTimer;
 
@@ -0,0 +1,208 @@
+/**
+ * @author Vladimir Pavliv
+ * @date 2025-03-02
+ */
+
+#ifndef HFT_TRADER_TRADERSESSION_HPP
+#define HFT_TRADER_TRADERSESSION_HPP
+
+#include <format>
+#include <memory>
+#include <vector>
+
+#include "boost_types.hpp"
+#include "config/config.hpp"
+#include "market_state.hpp"
+#include "market_types.hpp"
+#include "network/async_socket.hpp"
+#include "network_types.hpp"
+#include "rtt_tracker.hpp"
+#include "strategy.hpp"
+#include "template_types.hpp"
+#include "types.hpp"
+#include "utils/rng.hpp"
+#include "utils/utils.hpp"
+
+namespace hft::trader {
+
+using Tracker = RttTracker<RoundTrip, std::chrono::microseconds, 50, 200>;
+
+/**
+ * @brief Tick to trade segments: datagram received to order built, order built to handed
+ * to the socket, and from there to its status coming back
+ */
+struct DecideHop {
+  static constexpr auto NAME = "Tick->Decide";
+};
+struct SendHop {
+  static constexpr auto NAME = "Decide->Send";
+};
+struct AckHop {
+  static constexpr auto NAME = "Send->Status";
+};
+using DecideTracker = LatencyTracker<DecideHop, 1000, 5000, 20000>;
+using SendTracker = LatencyTracker<SendHop, 1000, 5000, 20000>;
+using AckTracker = LatencyTracker<AckHop, 20000, 100000, 1000000>;
+
+/**
+ * @brief One order stream with its own ingress/egress connection pair and ticker subset
+ * Runs entirely on the io_context it was created with, so sessions sharing a thread
+ * never contend, and RTT samples get aggregated by the tracker across threads.
+ * Orders come from the Strategy policy, see strategy.hpp
+ */
+template <typename Strategy>
+class TraderSession {
+  using StatusSocket = AsyncSocket<TcpSocket, OrderStatus>;
+  using OrderSocket = AsyncSocket<TcpSocket, LoginResponse>;
+
+public:
+  using UPtr = std::unique_ptr<TraderSession>;
+
+  TraderSession(IoContext &ctx, const MarketState &market, const std::vector<TickerId> &tickers,
+                const std::vector<TickerId> &hotTickers)
+      : mCtx{ctx}, mStrategy{market, tickers},
+        mIngressSocket{TcpSocket{mCtx},
+                       TcpEndpoint{Ip::make_address(Config::cfg.url), Config::cfg.portTcpOut},
+                       [this](const OrderStatus &status) { onOrderStatus(status); }},
+        mEgressSocket{TcpSocket{mCtx},
+                      TcpEndpoint{Ip::make_address(Config::cfg.url), Config::cfg.portTcpIn},
+                      [this](const LoginResponse &response) { onLoginResponse(response); }},
+        mTickers{tickers}, mHotTickers{hotTickers}, mTradeTimer{mCtx},
+        mTradeRate{Config::cfg.tradeRateUs}, mReactive{Config::cfg.tradeMode == "tick"} {}
+
+  void connect() {
+    mEgressSocket.asyncConnect([this]() { mEgressSocket.asyncRead(); });
+  }
+
+  void tradeStart() {
+    if (mTickers.empty()) {
+      return;
+    }
+    mTrading = true;
+    scheduleTradeTimer();
+  }
+
+  void tradeStop() {
+    mTrading = false;
+    mTradeTimer.cancel();
+  }
+
+  void setTradeRate(Microseconds rate) { mTradeRate = rate; }
+
+  /**
+   * @brief Price update of an own ticker in tick mode, called on the session thread
+   * that received the datagram at receivedNs
+   */
+  void onTick(TickerId tickerId, uint64_t receivedNs) {
+    if (!mLoggedIn || !mTrading) {
+      return;
+    }
+    Order order;
+    if (!mStrategy.onTick(tickerId, order)) {
+      return;
+    }
+    const uint64_t decided = DecideTracker::now();
+    DecideTracker::log(decided - receivedNs);
+    placeOrder(order);
+    SendTracker::logSince(decided);
+  }
+
+  TraderId traderId() const { return mTraderId; }
+
+private:
+  void onLoginResponse(const LoginResponse &response) {
+    mTraderId = response.traderId;
+    mToken = response.token;
+    mIngressSocket.asyncConnect([this]() {
+      LoginRequest request{mTraderId, mToken};
+      mIngressSocket.asyncWrite(Span<LoginRequest>{&request, 1});
+      mIngressSocket.asyncRead();
+      mLoggedIn = true;
+      Logger::monitorLogger->info("Session {} logged in, {} tickers", mTraderId, mTickers.size());
+      if (mTrading) {
+        scheduleTradeTimer();
+      }
+    });
+  }
+
+  void onOrderStatus(const OrderStatus &status) {
+    HFT_LOG_DEBUG("OrderStatus {}", status);
+    mStrategy.onStatus(status);
+    // Resting order fills come whenever someone trades against it, not as a response
+    if ((static_cast<uint8_t>(status.state) & static_cast<uint8_t>(OrderState::Resting)) != 0) {
+      return;
+    }
+    Tracker::logRtt(status.id);
+    if (mReactive) {
+      AckTracker::log(static_cast<TimestampRaw>(utils::getLinuxTimestamp() - status.id));
+    }
+  }
+
+  void scheduleTradeTimer() {
+    if (!mLoggedIn || mReactive) {
+      return;
+    }
+    mTradeTimer.expires_after(mTradeRate);
+    mTradeTimer.async_wait([this](BoostErrorRef ec) {
+      if (ec) {
+        return;
+      }
+      tradeSomething();
+      scheduleTradeTimer();
+    });
+  }
+
+  /**
+   * @brief Round robin over own tickers, unless skew is configured in which case
+   * hotSharePct of the flow goes to the hot tickers shared by all sessions
+   */
+  TickerId nextTicker() {
+    if (!mHotTickers.empty() && utils::RNG::rng<uint32_t>(99) < Config::cfg.hotSharePct) {
+      return mHotTickers[utils::RNG::rng<size_t>(mHotTickers.size() - 1)];
+    }
+    if (mCursor == mTickers.size()) {
+      mCursor = 0;
+    }
+    return mTickers[mCursor++];
+  }
+
+  void tradeSomething() {
+    Order order;
+    if (mStrategy.onTimer(nextTicker(), order)) {
+      placeOrder(order);
+    }
+  }
+
+  /**
+   * @brief Order id is the send timestamp, statuses coming back measure the round trip
+   */
+  void placeOrder(Order &order) {
+    order.id = utils::getLinuxTimestamp();
+    HFT_LOG_TRACE("Placing order {}", order);
+    mEgressSocket.asyncWrite(Span<Order>{&order, 1});
+  }
+
+private:
+  IoContext &mCtx;
+  Strategy mStrategy;
+
+  StatusSocket mIngressSocket;
+  OrderSocket mEgressSocket;
+
+  std::vector<TickerId> mTickers;
+  std::vector<TickerId> mHotTickers;
+  size_t mCursor{0};
+
+  SteadyTimer mTradeTimer;
+  Microseconds mTradeRate;
+
+  TraderId mTraderId{0};
+  SessionToken mToken{0};
+  bool mLoggedIn{false};
+  bool mTrading{false};
+  const bool mReactive;
+};
+
+} // namespace hft::trader
+
+#endif // HFT_TRADER_TRADERSESSION_HPP